@@ -91,6 +91,14 @@ private:
      * @return true if object has been constructed successfully.
      */
     bool_t construct();
+
+    /**
+     * @brief Tests if a driver resource is attached to a controller.
+     *
+     * @param number A number of the controller.
+     * @return True if the controller is owned by a resource.
+     */
+    static bool_t isAttached(Can::Number number);
         
     /**
      * @brief Initializes the allocator with heap for allocation.
@@ -35,6 +35,129 @@
     #define EOOS_GLOBAL_DRV_NUMBER_OF_CANS (1)
 #endif
 
+/**
+ * @brief Define driver subsystems to be built.
+ *
+ * @note
+ *  - If EOOS_GLOBAL_DRV_CAN_ENABLE_<subsystem_name> equals one, the subsystem is built.
+ *  - If EOOS_GLOBAL_DRV_CAN_ENABLE_<subsystem_name> equals zero, the subsystem is not built 
+ *    and it costs neither RAM nor flash nor interrupt vector.
+ *
+ * @note 
+ * 	The EOOS_GLOBAL_DRV_CAN_ENABLE_<subsystem_name> shall be passed to the project build system through compile definition.
+ */
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0
+    /**
+     * @brief RX FIFO 0 with its SW FIFO and interrupt.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 (1)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1
+    /**
+     * @brief RX FIFO 1 with its SW FIFO and interrupt.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 (1)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS
+    /**
+     * @brief Status change and error handler with its interrupt.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS (1)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE
+    /**
+     * @brief TX queueing that waits for a free TX mailbox on transmission with the TX interrupt.
+     *
+     * @note If the TX queueing is not built, a transmission fails if all TX mailboxes are busy.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE (1)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS
+    /**
+     * @brief Statistics counters like the transmit error counter.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS (1)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER
+    /**
+     * @brief RX worker thread that passes frames received to handlers in batches.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER (0)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES
+    /**
+     * @brief RX consumer lanes that distribute frames of RX FIFO to consumers by identifiers.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES (0)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_RAMFUNC
+    /**
+     * @brief Placement of the RX and TX interrupt hot paths in SRAM to run without flash wait states.
+     *
+     * @note The functions are placed to the .ramfunc.eoos.drv.can sections, which the application
+     *       linker script copies to SRAM by including the linker/drv.CanRamfunc.ld fragment.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_RAMFUNC (0)
+#endif
+
+#ifndef EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS
+    /**
+     * @brief Direct binding of the CAN vectors to the interrupt handlers of the driver.
+     *
+     * @note The driver defines the CMSIS vector handlers of CAN1, so the application vector table
+     *       has to route the vectors to them instead of the interrupt controller of the system.
+     *       The TX and RX FIFO 0 vectors are shared with USB, which cannot be used simultaneously.
+     */
+    #define EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS (0)
+#endif
+
+/**
+ * @brief Do compile error check of driver subsystems.
+ */
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_RAMFUNC != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_RAMFUNC != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_RAMFUNC must be equal to 0 or 1"
+#endif
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS != 0 && EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS != 1
+    #error "The EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS must be equal to 0 or 1"
+#endif
+
+/**
+ * @brief Define placement of the interrupt hot path functions.
+ */
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_RAMFUNC == 1
+    #define EOOS_DRV_CAN_RAMFUNC __attribute__((section(".ramfunc.eoos.drv.can"), noinline))
+#else
+    #define EOOS_DRV_CAN_RAMFUNC
+#endif
+
 /**
  * @brief Do compile error check of static allocated resources.
  */
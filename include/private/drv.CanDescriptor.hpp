@@ -0,0 +1,103 @@
+/**
+ * @file      drv.CanDescriptor.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANDESCRIPTOR_HPP_
+#define DRV_CANDESCRIPTOR_HPP_
+
+#include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @struct CanDescriptor
+ * @brief CAN controller descriptor.
+ *
+ * The descriptor gives all the resources of one controller, so the driver resources
+ * are not bound to CAN1, and a target or a host model with several controllers
+ * describes each controller by its own descriptor.
+ */
+struct CanDescriptor
+{
+    /**
+     * @brief Returns the descriptor of a controller of the target.
+     *
+     * @param number A number of the controller.
+     * @return The descriptor, or NULLPTR if the target has no such controller.
+     */
+    static CanDescriptor const* get(Can::Number number);
+
+    /**
+     * @brief Number of the controller.
+     */
+    Can::Number number;
+
+    /**
+     * @brief Index of the controller registers in the CPU register model.
+     */
+    int32_t index;
+
+    /**
+     * @brief Transmit interrupt source.
+     */
+    int32_t exceptionTx;
+
+    /**
+     * @brief FIFO 0 interrupt source.
+     */
+    int32_t exceptionRx0;
+
+    /**
+     * @brief FIFO 1 interrupt source.
+     */
+    int32_t exceptionRx1;
+
+    /**
+     * @brief Status change error interrupt source.
+     */
+    int32_t exceptionSce;
+
+    /**
+     * @brief Clock enable mask of the controller in RCC_APB1ENR.
+     */
+    uint32_t clock;
+
+    /**
+     * @brief Debug stop mask of the controller in DBGMCU_CR.
+     */
+    uint32_t debugStop;
+
+    /**
+     * @brief Index of the GPIO port of the pins in the CPU register model.
+     */
+    int32_t port;
+
+    /**
+     * @brief Clock enable mask of the GPIO port in RCC_APB2ENR.
+     */
+    uint32_t portClock;
+
+    /**
+     * @brief RX pin of the GPIO port from 8 to 15.
+     *
+     * @note AFIO_MAPR is not configured, so the pin is of the default mapping of the controller.
+     */
+    int32_t rxPin;
+
+    /**
+     * @brief TX pin of the GPIO port from 8 to 15.
+     *
+     * @note AFIO_MAPR is not configured, so the pin is of the default mapping of the controller.
+     */
+    int32_t txPin;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANDESCRIPTOR_HPP_
@@ -0,0 +1,240 @@
+/**
+ * @file      drv.CanRegister.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANREGISTER_HPP_
+#define DRV_CANREGISTER_HPP_
+
+#include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanRegisterField
+ * @brief CAN register field of compile-time position and width.
+ *
+ * @tparam P Position of the field.
+ * @tparam W Width of the field.
+ */
+template <uint32_t P, uint32_t W = 1>
+struct CanRegisterField
+{
+    /**
+     * @brief Position of the field.
+     */
+    static const uint32_t POS = P;
+
+    /**
+     * @brief Mask of the field in the register.
+     */
+    static const uint32_t MASK = ( (static_cast<uint32_t>(1) << W) - 1 ) << P;
+
+    /**
+     * @brief Returns a value placed to the field.
+     *
+     * @param value A value of the field.
+     * @return The register value with the field.
+     */
+    static uint32_t set(uint32_t value)
+    {
+        return (value << POS) & MASK;
+    }
+
+    /**
+     * @brief Returns a value of the field.
+     *
+     * @param value A register value.
+     * @return The value of the field.
+     */
+    static uint32_t get(uint32_t value)
+    {
+        return (value & MASK) >> POS;
+    }
+
+};
+
+/**
+ * @class CanRegisterNone
+ * @brief CAN register field of no bits to complete masks.
+ */
+struct CanRegisterNone
+{
+    /**
+     * @brief Mask of no bits.
+     */
+    static const uint32_t MASK = 0;
+};
+
+/**
+ * @class CanRegisterMask
+ * @brief CAN register mask composed of fields at compile time.
+ *
+ * @tparam F0-F7 Fields of the mask.
+ */
+template <class F0, class F1 = CanRegisterNone, class F2 = CanRegisterNone, class F3 = CanRegisterNone,
+          class F4 = CanRegisterNone, class F5 = CanRegisterNone, class F6 = CanRegisterNone, class F7 = CanRegisterNone>
+struct CanRegisterMask
+{
+    /**
+     * @brief Mask of the fields.
+     */
+    static const uint32_t MASK = F0::MASK | F1::MASK | F2::MASK | F3::MASK | F4::MASK | F5::MASK | F6::MASK | F7::MASK;
+};
+
+/**
+ * @class CanRegister
+ * @brief CAN register fields of STM32F103.
+ *
+ * The fields are accessed by masks known at compile time, so a write of several fields
+ * is one load and one store of the register, and a write-one-to-clear register is
+ * written by one store without a load. Unlike the bit-field copies of lib::Register,
+ * a write never stores back the status bits it has read.
+ */
+struct CanRegister
+{
+    /**
+     * @brief CAN_MCR fields.
+     */
+    struct Mcr
+    {
+        typedef CanRegisterField<0> Inrq;  ///< Initialization request
+        typedef CanRegisterField<1> Sleep; ///< Sleep mode request
+    };
+
+    /**
+     * @brief CAN_MSR fields.
+     */
+    struct Msr
+    {
+        typedef CanRegisterField<2> Erri; ///< Error interrupt
+    };
+
+    /**
+     * @brief CAN_TSR fields.
+     *
+     * The fields of mailbox 0 are given, and the fields of mailbox N are shifted by N * MAILBOX_POS.
+     * The mailbox empty flags are given for mailbox 0, and the flag of mailbox N is shifted by N.
+     */
+    struct Tsr
+    {
+        static const uint32_t MAILBOX_POS = 8;  ///< Position of fields of mailbox 1
+        typedef CanRegisterField<0>  Rqcp;      ///< Request completed mailbox 0
+        typedef CanRegisterField<1>  Txok;      ///< Transmission OK of mailbox 0
+        typedef CanRegisterField<2>  Alst;      ///< Arbitration lost for mailbox 0
+        typedef CanRegisterField<3>  Terr;      ///< Transmission error of mailbox 0
+        typedef CanRegisterField<0, 4> Status;  ///< Request status of mailbox 0
+        typedef CanRegisterField<26> Tme;       ///< Transmit mailbox 0 empty
+    };
+
+    /**
+     * @brief CAN_RFxR fields.
+     */
+    struct Rfxr
+    {
+        typedef CanRegisterField<0, 2> Fmp; ///< FIFO message pending
+        typedef CanRegisterField<3> Full;   ///< FIFO full
+        typedef CanRegisterField<4> Fovr;   ///< FIFO overrun
+        typedef CanRegisterField<5> Rfom;   ///< Release FIFO output mailbox
+    };
+
+    /**
+     * @brief CAN_IER fields.
+     */
+    struct Ier
+    {
+        typedef CanRegisterField<0>  Tmeie;  ///< Transmit mailbox empty interrupt enable
+        typedef CanRegisterField<1>  Fmpie0; ///< FIFO 0 message pending interrupt enable
+        typedef CanRegisterField<2>  Ffie0;  ///< FIFO 0 full interrupt enable
+        typedef CanRegisterField<3>  Fovie0; ///< FIFO 0 overrun interrupt enable
+        typedef CanRegisterField<4>  Fmpie1; ///< FIFO 1 message pending interrupt enable
+        typedef CanRegisterField<5>  Ffie1;  ///< FIFO 1 full interrupt enable
+        typedef CanRegisterField<6>  Fovie1; ///< FIFO 1 overrun interrupt enable
+        typedef CanRegisterField<8>  Ewgie;  ///< Error warning interrupt enable
+        typedef CanRegisterField<9>  Epvie;  ///< Error passive interrupt enable
+        typedef CanRegisterField<10> Bofie;  ///< Bus-off interrupt enable
+        typedef CanRegisterField<11> Lecie;  ///< Last error code interrupt enable
+        typedef CanRegisterField<15> Errie;  ///< Error interrupt enable
+        typedef CanRegisterField<16> Wkuie;  ///< Wakeup interrupt enable
+        typedef CanRegisterField<17> Slkie;  ///< Sleep interrupt enable
+        typedef CanRegisterMask<Fmpie0, Ffie0, Fovie0> Fifo0;                     ///< FIFO 0 interrupts
+        typedef CanRegisterMask<Fmpie1, Ffie1, Fovie1> Fifo1;                     ///< FIFO 1 interrupts
+        typedef CanRegisterMask<Ewgie, Epvie, Bofie, Lecie, Errie, Wkuie, Slkie> Status; ///< Status change interrupts
+    };
+
+    /**
+     * @brief CAN_ESR fields.
+     */
+    struct Esr
+    {
+        static const uint32_t LEC_BY_SOFTWARE = 7; ///< Last error code set by software
+        typedef CanRegisterField<4, 3> Lec;        ///< Last error code
+    };
+
+    /**
+     * @brief CAN_FMR fields.
+     */
+    struct Fmr
+    {
+        typedef CanRegisterField<0> Finit; ///< Filter initialization mode
+    };
+
+    /**
+     * @brief CAN_TIxR fields.
+     */
+    struct Tixr
+    {
+        typedef CanRegisterField<0> Txrq; ///< Transmit mailbox request
+    };
+
+    /**
+     * @brief CAN_TDTxR fields.
+     */
+    struct Tdtxr
+    {
+        typedef CanRegisterField<0, 4> Dlc; ///< Data length code
+    };
+
+    /**
+     * @brief Writes fields of a register by one load and one store.
+     *
+     * @tparam M Mask of the fields.
+     * @tparam R Register type.
+     * @param reg   A register.
+     * @param value A register value with the fields.
+     */
+    template <class M, class R>
+    static void modify(R volatile& reg, uint32_t value)
+    {
+        reg.value = ( reg.value & ~M::MASK ) | ( value & M::MASK );
+    }
+
+    /**
+     * @brief Sets or clears a bit of a filter bank register.
+     *
+     * @tparam R Register type.
+     * @param reg   A filter bank register.
+     * @param index An index of a filter bank.
+     * @param isSet The bit is set, or cleared.
+     */
+    template <class R>
+    static void assign(R volatile& reg, int32_t index, bool_t isSet)
+    {
+        uint32_t const bit( static_cast<uint32_t>(1) << index );
+        uint32_t value( reg.value & ~bit );
+        if( isSet )
+        {
+            value |= bit;
+        }
+        reg.value = value;
+    }
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANREGISTER_HPP_
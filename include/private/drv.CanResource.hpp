@@ -9,13 +9,18 @@
 #include "api.Supervisor.hpp"
 #include "lib.NonCopyable.hpp"
 #include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
 #include "drv.CanResourceTx.hpp"
 #include "drv.CanResourceRx.hpp"
 #include "drv.CanResourceStatus.hpp"
+#include "drv.CanResourcePower.hpp"
+#include "drv.CanResourceEvent.hpp"
+#include "drv.CanDescriptor.hpp"
+#include "drv.CanStatic.hpp"
+#include "drv.CanTimebase.hpp"
 #include "cpu.Registers.hpp"
-#include "sys.Mutex.hpp"
 #include "lib.Register.hpp"
-#include "lib.Guard.hpp"
+#include "drv.CanRegister.hpp"
 
 namespace eoos
 {
@@ -25,7 +30,13 @@ namespace drv
 /**
  * @class CanResource
  * @brief CAN device resource.
- * 
+ *
+ * The resource has no global lock as it is the only one of its controller, and
+ * the controller registers are configured by the constructor and the destructor only.
+ * The hot paths are lock-free: a transmission claims a free mailbox by an atomic flag,
+ * and each RX FIFO is a bounded queue with the FIFO interrupt as the only producer.
+ * The receive filter configuration keeps its own mutex as it is rarely changed.
+ *
  * @tparam A Heap memory allocator class.
  */
 template <class A>
@@ -59,22 +70,16 @@ public:
          */        
         api::Supervisor& svc;
 
-        /**
-         * @brief All the resource guard.
-         *
-         * @todo Clarify whether the mutex is needed at all here and in other such drivers.
-         */        
-        sys::Mutex mutex;
-
     };
 
     /**
      * @brief Constructor.
      *
      * @param data Global data for all resource objects.
+     * @param descriptor Descriptor of the controller.
      * @param config Configuration of the driver resource.     
      */
-    CanResource(Data& data, Config const& config);
+    CanResource(Data& data, CanDescriptor const& descriptor, Config const& config);
     
     /** 
      * @brief Destructor.
@@ -90,6 +95,16 @@ public:
      * @copydoc eoos::drv::Can::transmit()
      */
     virtual bool_t transmit(Message const& message);
+
+    /**
+     * @copydoc eoos::drv::Can::transmit(Frame const&)
+     */
+    virtual bool_t transmit(Frame const& frame);
+
+    /**
+     * @copydoc eoos::drv::Can::forward()
+     */
+    virtual bool_t forward(Frame const& frame);
     
     /**
      * @copydoc eoos::drv::Can::getTransmitErrorCounter()
@@ -100,11 +115,116 @@ public:
      * @copydoc eoos::drv::Can::receive()
      */
     virtual bool_t receive(Message* message, RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::receive(Frame*,RxFifo)
+     */
+    virtual bool_t receive(Frame* frame, RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::receive(Frame*,RxFifo,int32_t)
+     */
+    virtual bool_t receive(Frame* frame, RxFifo fifo, int32_t consumer);
+
+    /**
+     * @copydoc eoos::drv::Can::cancel()
+     */
+    virtual bool_t cancel(RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::setConsumers()
+     */
+    virtual bool_t setConsumers(RxFifo fifo, int32_t number);
+
+    /**
+     * @copydoc eoos::drv::Can::getLaneDropCounter()
+     */
+    virtual int32_t getLaneDropCounter(RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::transmitAsync()
+     */
+    virtual bool_t transmitAsync(Request* request);
+
+    /**
+     * @copydoc eoos::drv::Can::receiveAsync()
+     */
+    virtual bool_t receiveAsync(Request* request, RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::wait()
+     */
+    virtual uint32_t wait(uint32_t events);
     
     /**
      * @copydoc eoos::drv::Can::setReceiveFilter()
      */
     virtual bool_t setReceiveFilter(RxFilter const& filter);
+
+    /**
+     * @copydoc eoos::drv::Can::setRecorder()
+     */
+    virtual bool_t setRecorder(CanRecorder* recorder);
+
+    /**
+     * @copydoc eoos::drv::Can::setMonitor()
+     */
+    virtual bool_t setMonitor(CanMonitor* monitor);
+
+    /**
+     * @copydoc eoos::drv::Can::setRouter()
+     */
+    virtual bool_t setRouter(CanRouter* router);
+
+    /**
+     * @copydoc eoos::drv::Can::setHandler()
+     */
+    virtual bool_t setHandler(Handler* handler, RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::inject()
+     */
+    virtual bool_t inject(Message const& message, RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::sleep()
+     */
+    virtual bool_t sleep();
+
+    /**
+     * @copydoc eoos::drv::Can::wakeUp()
+     */
+    virtual bool_t wakeUp();
+
+    /**
+     * @copydoc eoos::drv::Can::isSleeping()
+     */
+    virtual bool_t isSleeping() const;
+
+    /**
+     * @copydoc eoos::drv::Can::getWakeUpLatency()
+     */
+    virtual uint32_t getWakeUpLatency() const;
+
+    /**
+     * @copydoc eoos::drv::Can::idle()
+     */
+    virtual bool_t idle();
+
+    /**
+     * @copydoc eoos::drv::Can::getGatedTime()
+     */
+    virtual uint64_t getGatedTime();
+
+    /**
+     * @copydoc eoos::drv::Can::isReady()
+     */
+    virtual bool_t isReady();
+
+    /**
+     * @copydoc eoos::drv::Can::getInitTime()
+     */
+    virtual uint32_t getInitTime() const;
         
 protected:
 
@@ -112,6 +232,18 @@ protected:
 
 private:
 
+    /**
+     * @enum InitState
+     * @brief State of the controller initialization.
+     */
+    enum InitState
+    {
+        INITSTATE_ENTER = 0, ///< Waiting for the initialization mode acknowledge
+        INITSTATE_LEAVE,     ///< Waiting for the normal mode acknowledge
+        INITSTATE_READY,     ///< The controller is in the normal mode
+        INITSTATE_FAILED     ///< The initialization has failed
+    };
+
     /**
      * @brief Constructs this object.
      *
@@ -129,15 +261,71 @@ private:
     /**
      * @brief Initializes the hardware.
      *
-     * @return True if initialized.
+     * The function requests the initialization mode, and waits for the normal mode
+     * if the initialization is synchronous.
+     *
+     * @return True if initialized, or the asynchronous initialization is started.
      */
     bool_t initialize();
 
+    /**
+     * @brief Advances the initialization by one step without waiting.
+     */
+    void advance();
+
+    /**
+     * @brief Configures the controller in the initialization mode.
+     *
+     * @return True if configured.
+     */
+    bool_t configure();
+
+    /**
+     * @brief Enables the controller interrupts.
+     */
+    void enableInterrupts();
+
+    /**
+     * @brief Starts a step of the initialization.
+     *
+     * @param state A state of the step.
+     */
+    void startStep(InitState state);
+
+    /**
+     * @brief Tests if the current step of the initialization is timed out.
+     *
+     * @return True if timed out.
+     */
+    bool_t isStepTimeout();
+
+    /**
+     * @brief Returns the step timeout.
+     *
+     * The default timeout is the time of INIT_TIMEOUT_IN_BITS bits on the bus,
+     * which covers a frame in progress to complete and 11 recessive bits to synchronize.
+     *
+     * @return Timeout in microseconds.
+     */
+    uint32_t getStepTimeout() const;
+
     /**
      * @brief Deinitializes the hardware.
      */
     void deinitialize();
 
+    /**
+     * @brief Attaches this resource to the static interface of the controller.
+     *
+     * @return True if attached.
+     */
+    bool_t attach();
+
+    /**
+     * @brief Detaches this resource from the static interface of the controller.
+     */
+    void detach();
+
     /**
      * @brief Checks system clocks.
      *
@@ -167,12 +355,52 @@ private:
      * @brief Number of RX FIFOs.
      */    
     static const int32_t NUMBER_OF_RX_FIFOS = 2;
+
+    /**
+     * @brief Default timeout of an initialization step in bits on the bus.
+     */
+    static const uint32_t INIT_TIMEOUT_IN_BITS = 512;
+
+    /**
+     * @brief Timeout of an initialization step in register polls if no timebase given.
+     */
+    static const uint32_t INIT_TIMEOUT_IN_POLLS = 0x0000FFFF;
+
+    /**
+     * @brief First pin of a GPIO port configured by GPIOx_CRH.
+     */
+    static const int32_t GPIO_CRH_FIRST_PIN = 8;
+
+    /**
+     * @brief Width of a pin configuration in GPIOx_CRH.
+     */
+    static const int32_t GPIO_CRH_PIN_WIDTH = 4;
+
+    /**
+     * @brief Mask of a pin configuration in GPIOx_CRH.
+     */
+    static const uint32_t GPIO_CRH_PIN_MASK = 0x0000000F;
+
+    /**
+     * @brief RX pin configuration of input with pull-up or pull-down, as floating input does not work.
+     */
+    static const uint32_t GPIO_CRH_RX_CONFIG = 0x00000008;
+
+    /**
+     * @brief TX pin configuration of alternate function push-pull output of 50 MHz.
+     */
+    static const uint32_t GPIO_CRH_TX_CONFIG = 0x0000000B;
     
     /**
      * @brief Global data for all these objects;
      */
     Data& data_;
         
+    /**
+     * @brief Descriptor of the controller.
+     */
+    CanDescriptor const& descriptor_;
+
     /**
      * @brief Configuration of the resource.
      */
@@ -182,6 +410,16 @@ private:
      * @brief CAN registers.
      */
     cpu::reg::Can* reg_;
+
+    /**
+     * @brief Event wait resource.
+     */
+    CanResourceEvent event_;
+
+    /**
+     * @brief Low-power resource.
+     */
+    CanResourcePower power_;
         
     /**
      * @brief TX resource.
@@ -192,24 +430,67 @@ private:
      * @brief RX resource.
      */        
     CanResourceRx rx_;
-    
+
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
     /**
      * @brief Status change errror resource.
      */    
     CanResourceStatus sce_;
+    #endif
+
+    /**
+     * @brief The resource is attached to the controller, so it owns the hardware.
+     */
+    bool_t isAttached_;
+
+    /**
+     * @brief State of the initialization.
+     */
+    InitState volatile initState_;
+
+    /**
+     * @brief Time of the initialization start.
+     */
+    uint32_t initStart_;
+
+    /**
+     * @brief Time of the current initialization step start.
+     */
+    uint32_t stepStart_;
+
+    /**
+     * @brief Register polls of the current initialization step.
+     */
+    uint32_t stepPolls_;
+
+    /**
+     * @brief Measured time of the initialization.
+     */
+    uint32_t initTime_;
 
 };
 
 template <class A>
-CanResource<A>::CanResource(Data& data, Config const& config)
+CanResource<A>::CanResource(Data& data, CanDescriptor const& descriptor, Config const& config)
     : lib::NonCopyable<A>()
     , Can()
     , data_( data )
+    , descriptor_( descriptor )
     , config_( config )
-    , reg_( data_.reg.can[config_.number]  )  
-    , tx_( reg_, data_.svc )
-    , rx_( config_, reg_, data_.svc )
-    , sce_( reg_, data_.svc ) {
+    , reg_( data_.reg.can[descriptor_.index]  )  
+    , event_()
+    , power_( descriptor_, reg_, data_.reg.rcc, config_ )
+    , tx_( descriptor_, reg_, data_.svc, power_, event_ )
+    , rx_( config_, descriptor_, reg_, data_.svc, power_, event_ )
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
+    , sce_( descriptor_, reg_, data_.svc, power_, event_ )
+    #endif
+    , isAttached_( false )
+    , initState_( INITSTATE_FAILED )
+    , initStart_( 0 )
+    , stepStart_( 0 )
+    , stepPolls_( 0 )
+    , initTime_( 0 ) {
     bool_t const isConstructed( construct() );
     setConstructed( isConstructed );
 }    
@@ -217,7 +498,12 @@ CanResource<A>::CanResource(Data& data, Config const& config)
 template <class A>
 CanResource<A>::~CanResource()
 {
-    deinitialize();
+    // A resource not attached shall not touch the controller owned by another resource
+    if( isAttached_ )
+    {
+        detach();
+        deinitialize();
+    }
 }
 
 template <class A>
@@ -232,6 +518,18 @@ bool_t CanResource<A>::transmit(Message const& message)
     return tx_.transmit(message);
 }
 
+template <class A>
+bool_t CanResource<A>::transmit(Frame const& frame)
+{
+    return tx_.transmit(frame);
+}
+
+template <class A>
+bool_t CanResource<A>::forward(Frame const& frame)
+{
+    return tx_.forward(frame);
+}
+
 template <class A>
 int32_t CanResource<A>::getTransmitErrorCounter() const
 {
@@ -244,12 +542,228 @@ bool_t CanResource<A>::receive(Message* message, RxFifo fifo)
     return rx_.receive(message, fifo);
 }
 
+template <class A>
+bool_t CanResource<A>::receive(Frame* frame, RxFifo fifo)
+{
+    return rx_.receive(frame, fifo);
+}
+
+template <class A>
+bool_t CanResource<A>::receive(Frame* frame, RxFifo fifo, int32_t consumer)
+{
+    return rx_.receive(frame, fifo, consumer);
+}
+
+template <class A>
+bool_t CanResource<A>::cancel(RxFifo fifo)
+{
+    return rx_.cancel(fifo);
+}
+
+template <class A>
+bool_t CanResource<A>::setConsumers(RxFifo fifo, int32_t number)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        res = rx_.setConsumers(fifo, number);
+    }
+    return res;
+}
+
+template <class A>
+int32_t CanResource<A>::getLaneDropCounter(RxFifo fifo)
+{
+    return rx_.getLaneDropCounter(fifo);
+}
+
+template <class A>
+bool_t CanResource<A>::transmitAsync(Request* request)
+{
+    return tx_.transmitAsync(request);
+}
+
+template <class A>
+bool_t CanResource<A>::receiveAsync(Request* request, RxFifo fifo)
+{
+    return rx_.receiveAsync(request, fifo);
+}
+
+template <class A>
+uint32_t CanResource<A>::wait(uint32_t events)
+{
+    uint32_t res( 0 );
+    if( isConstructed() )
+    {
+        events &= EVENT_ALL;
+        while( events != 0 )
+        {
+            // Arm the events first as an event signaled after its test has to wake up
+            event_.arm(events);
+            res = rx_.poll(events) | tx_.poll(events) | event_.take(events & EVENT_STATUS);
+            if( res != 0 )
+            {
+                break;
+            }
+            if( !event_.wait() )
+            {
+                break;
+            }
+        }
+        event_.disarm();
+    }
+    return res;
+}
+
 template <class A>
 bool_t CanResource<A>::setReceiveFilter(RxFilter const& filter)
 {
     return rx_.setReceiveFilter(filter);
 }
 
+template <class A>
+bool_t CanResource<A>::setRecorder(CanRecorder* recorder)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        tx_.setRecorder(recorder);
+        rx_.setRecorder(recorder);
+        res = true;
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::setMonitor(CanMonitor* monitor)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        rx_.setMonitor(monitor);
+        res = true;
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::setRouter(CanRouter* router)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        rx_.setRouter(router);
+        res = true;
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::setHandler(Handler* handler, RxFifo fifo)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        res = rx_.setHandler(handler, fifo);
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::inject(Message const& message, RxFifo fifo)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        // Lock out the interrupts which pass frames to the recorder, monitor and router shared with the injection
+        tx_.disable();
+        rx_.disable();
+        res = rx_.inject(message, fifo);
+        rx_.enable();
+        tx_.enable();
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::sleep()
+{
+    bool_t res( false );
+    if( isConstructed() && initState_ == INITSTATE_READY )
+    {
+        res = power_.sleep();
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::wakeUp()
+{
+    bool_t res( false );
+    if( isConstructed() && initState_ == INITSTATE_READY )
+    {
+        res = power_.wakeUp();
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::isSleeping() const
+{
+    return power_.isSleeping();
+}
+
+template <class A>
+uint32_t CanResource<A>::getWakeUpLatency() const
+{
+    return power_.getWakeUpLatency();
+}
+
+template <class A>
+bool_t CanResource<A>::idle()
+{
+    bool_t res( false );
+    if( isConstructed() && initState_ == INITSTATE_READY )
+    {
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
+        // Lock out the wake-up interrupt while the controller is tested and gated
+        sce_.disable();
+        #endif
+        res = power_.idle();
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
+        sce_.enable();
+        #endif
+    }
+    return res;
+}
+
+template <class A>
+uint64_t CanResource<A>::getGatedTime()
+{
+    return power_.getGatedTime();
+}
+
+template <class A>
+bool_t CanResource<A>::isReady()
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        if( initState_ == INITSTATE_ENTER || initState_ == INITSTATE_LEAVE )
+        {
+            advance();
+        }
+        res = ( initState_ == INITSTATE_READY ) ? true : false;
+    }
+    return res;
+}
+
+template <class A>
+uint32_t CanResource<A>::getInitTime() const
+{
+    return ( initState_ == INITSTATE_READY ) ? initTime_ : 0;
+}
+
 template <class A>
 bool_t CanResource<A>::construct()
 {
@@ -264,6 +778,18 @@ bool_t CanResource<A>::construct()
         {
             break;
         }
+        if( config_.isAsync && config_.timebase == NULLPTR )
+        {
+            break;
+        }
+        if( !event_.isConstructed() )
+        {
+            break;
+        }
+        if( !power_.isConstructed() )
+        {
+            break;
+        }
         if( !tx_.isConstructed() )
         {
             break;
@@ -272,6 +798,18 @@ bool_t CanResource<A>::construct()
         {
             break;
         }
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
+        if( !sce_.isConstructed() )
+        {
+            break;
+        }
+        #endif
+        // Attach before the interrupts are enabled as the vectors may be bound to the static interface
+        isAttached_ = attach();
+        if( !isAttached_ )
+        {
+            break;
+        }
         if( !initialize() )
         {
             break;
@@ -284,7 +822,7 @@ bool_t CanResource<A>::construct()
 template<class A>
 bool_t CanResource<A>::isNumberValid()
 {
-    return NUMBER_CAN1 == config_.number;
+    return descriptor_.number == config_.number;
 }
 
 template <class A>
@@ -293,11 +831,7 @@ bool_t CanResource<A>::initialize()
     bool_t res( false );
     do 
     {
-        lib::Guard<A> const guard(data_.mutex);
         lib::Register<cpu::reg::Can::Mcr> mcr( reg_->mcr );
-        lib::Register<cpu::reg::Can::Msr> msr( reg_->msr );
-        lib::Register<cpu::reg::Can::Btr> btr( reg_->btr );
-        lib::Register<cpu::reg::Can::Ier> ier( reg_->ier );
         if( !checkClocks() )
         {
             break;
@@ -307,177 +841,299 @@ bool_t CanResource<A>::initialize()
         {
             break;
         }
+        if( config_.timebase != NULLPTR )
+        {
+            initStart_ = config_.timebase->getTime();
+        }
         // Exit sleep mode
         mcr.fetch().bit().sleep = 0;
         mcr.commit();
         // Enter to the Initialization mode
         mcr.fetch().bit().inrq = 1;
         mcr.commit();
-        // Wait the acknowledge
-        uint32_t timeout( 0x0000FFFF );
-        while( true )
+        startStep(INITSTATE_ENTER);
+        if( config_.isAsync )
         {
-            if( msr.fetch().bit().inak == 1 )
-            {
-                break;
-            }
-            if( timeout-- == 0 )
-            {
-                break;
-            }
+            res = true;
+            break;
         }
-        if( timeout == 0 )
+        // Wait the acknowledges
+        while( initState_ == INITSTATE_ENTER || initState_ == INITSTATE_LEAVE )
         {
-            break;
+            advance();
         }
-        // Set master control register        
-        mcr.fetch();
-        mcr.bit().txfp = config_.reg.mcr.txfp; ///< Transmit FIFO priority            (reset value is 0)
-        mcr.bit().rflm = config_.reg.mcr.rflm; ///< Receive FIFO locked mode          (reset value is 0)
-        mcr.bit().nart = 0;                    ///< No automatic retransmission       (reset value is 0)
-        mcr.bit().awum = 0;                    ///< Automatic wake-up mode            (reset value is 0)
-        mcr.bit().abom = 0;                    ///< Automatic bus-off management      (reset value is 0)
-        mcr.bit().ttcm = 0;                    ///< Time triggered communication mode (reset value is 0)
-        mcr.bit().dbf  = config_.reg.mcr.dbf;  ///< CAN RX and TX frozen during debug (reset value is 1)
-        mcr.commit();
-        // Set debug mode
-        if( config_.reg.mcr.dbf == 1 )
+        if( initState_ != INITSTATE_READY )
         {
-            lib::Register<cpu::reg::Dbg::Cr> cr( data_.reg.dbg->cr );
-            cr.fetch().bit().dbgcan1stop = 1;
-            cr.commit();
+            break;
         }
-        // Set the bit timing register
-        btr.fetch();
-        btr.bit().lbkm = config_.reg.btr.lbkm;
-        btr.bit().silm = config_.reg.btr.silm;
-        btr.commit();
-        // Set bus bit rate
-        if( !setBitRate() )
+        // Complite successfully
+        res = true;
+    } while(false);
+    return res;
+}
+
+template <class A>
+void CanResource<A>::advance()
+{
+    lib::Register<cpu::reg::Can::Mcr> mcr( reg_->mcr );
+    lib::Register<cpu::reg::Can::Msr> msr( reg_->msr );
+    switch( initState_ )
+    {
+        case INITSTATE_ENTER:
         {
+            if( msr.fetch().bit().inak == 1 )
+            {
+                if( !configure() )
+                {
+                    initState_ = INITSTATE_FAILED;
+                    break;
+                }
+                // Enter to the Normal mode
+                mcr.fetch().bit().inrq = 0;
+                mcr.commit();
+                startStep(INITSTATE_LEAVE);
+            }
+            else if( isStepTimeout() )
+            {
+                initState_ = INITSTATE_FAILED;
+            }
             break;
         }
-        // Enter to the Normal mode
-        mcr.fetch().bit().inrq = 0;
-        mcr.commit();
-        // Wait the acknowledge
-        timeout = 0x0000FFFF;
-        while( true )
+        case INITSTATE_LEAVE:
         {
             if( msr.fetch().bit().inak == 0 )
             {
-                break;
+                enableInterrupts();
+                if( config_.timebase != NULLPTR )
+                {
+                    initTime_ = config_.timebase->getTime() - initStart_;
+                }
+                initState_ = INITSTATE_READY;
             }
-            if( timeout-- == 0 )
+            else if( isStepTimeout() )
             {
-                break;
+                initState_ = INITSTATE_FAILED;
             }
+            break;
         }
-        if( timeout == 0 )
+        default:
         {
             break;
         }
-        // Enable interrupts
-        ier.fetch();
-        // Transmit interrupt
-        ier.bit().tmeie  = 1;
-        // FIFO 0 interrupt
-        ier.bit().fmpie0 = 1;
-        ier.bit().ffie0  = 1;
-        ier.bit().fovie0 = 1;
-        // FIFO 1 interrupt        
-        ier.bit().fmpie1 = 1;
-        ier.bit().ffie1  = 1;
-        ier.bit().fovie1 = 1;
-        // Error and status change interrupt
-        ier.bit().ewgie  = 1;
-        ier.bit().epvie  = 1;
-        ier.bit().bofie  = 1;
-        ier.bit().lecie  = 1;
-        ier.bit().errie  = 1;
-        ier.bit().wkuie  = 1;
-        ier.bit().slkie  = 1;
-        ier.commit();
-        // Complite successfully
-        res = true;
-    } while(false);
-    return res;
+    }
 }
 
 template <class A>
-void CanResource<A>::deinitialize()
+bool_t CanResource<A>::configure()
+{
+    lib::Register<cpu::reg::Can::Mcr> mcr( reg_->mcr );
+    lib::Register<cpu::reg::Can::Btr> btr( reg_->btr );
+    // Set master control register        
+    mcr.fetch();
+    mcr.bit().txfp = config_.reg.mcr.txfp; ///< Transmit FIFO priority            (reset value is 0)
+    mcr.bit().rflm = config_.reg.mcr.rflm; ///< Receive FIFO locked mode          (reset value is 0)
+    mcr.bit().nart = 0;                    ///< No automatic retransmission       (reset value is 0)
+    mcr.bit().awum = config_.reg.mcr.awum; ///< Automatic wake-up mode            (reset value is 0)
+    mcr.bit().abom = 0;                    ///< Automatic bus-off management      (reset value is 0)
+    mcr.bit().ttcm = 0;                    ///< Time triggered communication mode (reset value is 0)
+    mcr.bit().dbf  = config_.reg.mcr.dbf;  ///< CAN RX and TX frozen during debug (reset value is 1)
+    mcr.commit();
+    // Set debug mode
+    if( config_.reg.mcr.dbf == 1 )
+    {
+        data_.reg.dbg->cr.value |= descriptor_.debugStop;
+    }
+    // Set the bit timing register
+    btr.fetch();
+    btr.bit().lbkm = config_.reg.btr.lbkm;
+    btr.bit().silm = config_.reg.btr.silm;
+    btr.commit();
+    // Set bus bit rate
+    return setBitRate();
+}
+
+template <class A>
+void CanResource<A>::enableInterrupts()
 {
-    lib::Guard<A> const guard(data_.mutex);
-    lib::Register<cpu::reg::Can::Ier> ier( reg_->ier );
-    // Disable interrupts
-    ier.fetch();
+    uint32_t ier( 0 );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
     // Transmit interrupt
-    ier.bit().tmeie  = 0;
+    ier |= CanRegister::Ier::Tmeie::MASK;
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
     // FIFO 0 interrupt
-    ier.bit().fmpie0 = 0;
-    ier.bit().ffie0  = 0;
-    ier.bit().fovie0 = 0;
+    ier |= CanRegister::Ier::Fifo0::MASK;
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
     // FIFO 1 interrupt        
-    ier.bit().fmpie1 = 0;
-    ier.bit().ffie1  = 0;
-    ier.bit().fovie1 = 0;
+    ier |= CanRegister::Ier::Fifo1::MASK;
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
     // Error and status change interrupt
-    ier.bit().ewgie  = 0;
-    ier.bit().epvie  = 0;
-    ier.bit().bofie  = 0;
-    ier.bit().lecie  = 0;
-    ier.bit().errie  = 0;
-    ier.bit().wkuie  = 0;
-    ier.bit().slkie  = 0;
-    ier.commit();
+    ier |= CanRegister::Ier::Status::MASK;
+    #endif
+    // The mask is a constant, so the interrupts are enabled by one load and one store
+    reg_->ier.value |= ier;
+}
+
+template <class A>
+void CanResource<A>::startStep(InitState state)
+{
+    if( config_.timebase != NULLPTR )
+    {
+        stepStart_ = config_.timebase->getTime();
+    }
+    stepPolls_ = 0;
+    initState_ = state;
+}
+
+template <class A>
+bool_t CanResource<A>::isStepTimeout()
+{
+    bool_t res( false );
+    if( config_.timebase != NULLPTR )
+    {
+        uint32_t const time( config_.timebase->getTime() - stepStart_ );
+        res = ( time > getStepTimeout() ) ? true : false;
+    }
+    else
+    {
+        res = ( ++stepPolls_ > INIT_TIMEOUT_IN_POLLS ) ? true : false;
+    }
+    return res;
+}
+
+template <class A>
+uint32_t CanResource<A>::getStepTimeout() const
+{
+    // Bit time in microseconds rounded up
+    uint32_t const bitTime[9] = {
+        1,   // 1000 Kbit/s
+        2,   // 800 Kbit/s
+        2,   // 500 Kbit/s
+        4,   // 250 Kbit/s
+        8,   // 125 Kbit/s
+        10,  // 100 Kbit/s
+        20,  // 50 Kbit/s
+        50,  // 20 Kbit/s
+        100  // 10 Kbit/s
+    };
+    uint32_t timeout( config_.initTimeout );
+    if( timeout == 0 )
+    {
+        timeout = bitTime[config_.bitRate] * INIT_TIMEOUT_IN_BITS;
+    }
+    return timeout;
+}
+
+template <class A>
+void CanResource<A>::deinitialize()
+{
+    // Disable transmit, FIFO 0, FIFO 1, error and status change interrupts
+    CanRegister::modify< CanRegisterMask<CanRegister::Ier::Tmeie, CanRegister::Ier::Fifo0, CanRegister::Ier::Fifo1, CanRegister::Ier::Status> >( reg_->ier, 0 );
     // Disable clock peripheral.        
     static_cast<void>(enableClock(false));
 }
 
 template <class A>
-bool_t CanResource<A>::checkClocks()
+bool_t CanResource<A>::attach()
 {
     bool_t res( false );
-    if( data_.svc.getProcessor().getPllController().getCpuClock() == 72000000 )
+    switch( config_.number )
     {
-        res = true;
+        case NUMBER_CAN1:
+        {
+            #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
+            res = CanStatic<NUMBER_CAN1>::attach(&tx_, &rx_, &sce_);
+            #else
+            res = CanStatic<NUMBER_CAN1>::attach(&tx_, &rx_, NULLPTR);
+            #endif
+            break;
+        }
+        case NUMBER_CAN2:
+        {
+            #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATUS == 1
+            res = CanStatic<NUMBER_CAN2>::attach(&tx_, &rx_, &sce_);
+            #else
+            res = CanStatic<NUMBER_CAN2>::attach(&tx_, &rx_, NULLPTR);
+            #endif
+            break;
+        }
+        default:
+        {
+            res = false;
+            break;
+        }
     }
     return res;
 }
 
 template <class A>
-bool_t CanResource<A>::enableClock(bool_t enable)
+void CanResource<A>::detach()
 {
-    bool_t res(true);
-    uint32_t en = (enable) ? 1 : 0;
     switch( config_.number )
     {
         case NUMBER_CAN1:
         {
-            // CAN1 clock enabled
-            lib::Register<cpu::reg::Rcc::Apb1enr> apb1enr( data_.reg.rcc->apb1enr );
-            apb1enr.fetch().bit().can1en = en;
-            apb1enr.commit();
-            // IO port A clock enabled            
-            data_.reg.rcc->apb2enr.bit.iopaen = 1; 
-            // IO port A configuration
-            int32_t const index( cpu::Registers::INDEX_GPIOA );            
-            cpu::reg::Gpio::Crh crh( data_.reg.gpio[index]->crh.value );
-            // CAN1_RX port PA11
-            crh.bit.cnf11 = 2;       // Input with pull-up / pull-down as Floating input does not work
-            crh.bit.mode11 = 0;      // Input mode (state after reset)
-            // CAN1_TX port PA12
-            crh.bit.cnf12 = 2;      // Alternate function output Push-pull
-            crh.bit.mode12 = 3;     // Output mode, max speed 50 MHz.
-            data_.reg.gpio[index]->crh.value = crh.value;          
+            CanStatic<NUMBER_CAN1>::detach(&tx_);
+            break;
+        }
+        case NUMBER_CAN2:
+        {
+            CanStatic<NUMBER_CAN2>::detach(&tx_);
             break;
         }
         default:
         {
-            res = false;
             break;
         }
     }
+}
+
+template <class A>
+bool_t CanResource<A>::checkClocks()
+{
+    bool_t res( false );
+    if( data_.svc.getProcessor().getPllController().getCpuClock() == 72000000 )
+    {
+        res = true;
+    }
+    return res;
+}
+
+template <class A>
+bool_t CanResource<A>::enableClock(bool_t enable)
+{
+    bool_t res( false );
+    int32_t const rxPin( descriptor_.rxPin - GPIO_CRH_FIRST_PIN );
+    int32_t const txPin( descriptor_.txPin - GPIO_CRH_FIRST_PIN );
+    int32_t const numberOfPins( 32 / GPIO_CRH_PIN_WIDTH );
+    if( rxPin >= 0 && rxPin < numberOfPins && txPin >= 0 && txPin < numberOfPins )
+    {
+        // CAN clock enabled
+        if( enable )
+        {
+            data_.reg.rcc->apb1enr.value |= descriptor_.clock;
+        }
+        else
+        {
+            data_.reg.rcc->apb1enr.value &= ~descriptor_.clock;
+        }
+        // IO port clock enabled            
+        data_.reg.rcc->apb2enr.value |= descriptor_.portClock;
+        // IO port configuration
+        uint32_t const rxPos( static_cast<uint32_t>(rxPin * GPIO_CRH_PIN_WIDTH) );
+        uint32_t const txPos( static_cast<uint32_t>(txPin * GPIO_CRH_PIN_WIDTH) );
+        cpu::reg::Gpio::Crh volatile& crh( data_.reg.gpio[descriptor_.port]->crh );
+        uint32_t value( crh.value );
+        value &= ~( (GPIO_CRH_PIN_MASK << rxPos) | (GPIO_CRH_PIN_MASK << txPos) );
+        // CAN RX port
+        value |= GPIO_CRH_RX_CONFIG << rxPos;
+        // CAN TX port
+        value |= GPIO_CRH_TX_CONFIG << txPos;
+        crh.value = value;
+        res = true;
+    }
     return res;
 }
 
@@ -535,8 +1191,7 @@ bool_t CanResource<A>::setBitRate()
 template <class A>
 CanResource<A>::Data::Data(cpu::Registers& areg, api::Supervisor& asvc)
     : reg( areg )
-    , svc( asvc )
-    , mutex() {
+    , svc( asvc ) {
 }
 
 } // namespace drv
@@ -0,0 +1,139 @@
+/**
+ * @file      drv.CanResourceEvent.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRESOURCEEVENT_HPP_
+#define DRV_CANRESOURCEEVENT_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+#include "sys.Semaphore.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanResourceEvent
+ * @brief CAN event wait resource.
+ *
+ * A waiting task arms the events it waits for, tests them, and blocks on a binary semaphore.
+ * The interrupts signal events, and the semaphore is released only if a signaled event is armed,
+ * so the interrupts of events nobody waits for cost one load. As the semaphore may be released
+ * after the task has found an event, a wake-up may be spurious, and the task has to test
+ * the events again after each wake-up.
+ */
+class CanResourceEvent : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    CanResourceEvent();
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanResourceEvent();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Arms events to wait for.
+     *
+     * @param events Bitmask of events.
+     */
+    void arm(uint32_t events);
+
+    /**
+     * @brief Disarms all events.
+     */
+    void disarm();
+
+    /**
+     * @brief Waits for an armed event is signaled.
+     *
+     * @return True if the wait has been completed.
+     */
+    bool_t wait();
+
+    /**
+     * @brief Signals events from a thread.
+     *
+     * @param events Bitmask of events.
+     */
+    void signal(uint32_t events);
+
+    /**
+     * @brief Signals events from an interrupt.
+     *
+     * @param events Bitmask of events.
+     */
+    void signalFromInterrupt(uint32_t events);
+
+    /**
+     * @brief Latches events, which are kept till they are taken, and signals them from an interrupt.
+     *
+     * @param events Bitmask of events.
+     */
+    void latchFromInterrupt(uint32_t events);
+
+    /**
+     * @brief Takes latched events.
+     *
+     * @param events Bitmask of events to take.
+     * @return Bitmask of the events which have been latched.
+     */
+    uint32_t take(uint32_t events);
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Disarms all events if one of given events is armed.
+     *
+     * @param events Bitmask of events.
+     * @return True if disarmed, so the semaphore has to be released.
+     */
+    bool_t trigger(uint32_t events);
+
+    /**
+     * @brief Wake-up semaphore.
+     */
+    sys::Semaphore sem_;
+
+    /**
+     * @brief Bitmask of armed events.
+     */
+    uint32_t volatile armed_;
+
+    /**
+     * @brief Bitmask of latched events.
+     */
+    uint32_t volatile latched_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRESOURCEEVENT_HPP_
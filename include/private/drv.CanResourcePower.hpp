@@ -0,0 +1,233 @@
+/**
+ * @file      drv.CanResourcePower.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRESOURCEPOWER_HPP_
+#define DRV_CANRESOURCEPOWER_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+#include "drv.CanTimebase.hpp"
+#include "drv.CanDescriptor.hpp"
+#include "cpu.Registers.hpp"
+#include "sys.Mutex.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanResourcePower
+ * @brief CAN low-power resource.
+ *
+ * The resource requests the sleep mode, and resumes the normal mode on a software
+ * request or on the wake-up interrupt. Resuming does not reinitialize the controller,
+ * and the filters, the mailboxes and the SW FIFOs are kept as they are.
+ * The wake-up and sleep acknowledge interrupts come through the status change
+ * interrupt, so without the status resource only the automatic wake-up mode works.
+ *
+ * If an idle timeout is configured, the resource gates the peripheral clock after
+ * the controller has been in the sleep mode with no pending transmission for the timeout.
+ * The clock is ungated on a transmission or a wake-up request. As the controller cannot
+ * detect bus activity without the clock, a wake-up on the bus has to be caught outside,
+ * for example by an EXTI interrupt on the CAN RX pin calling the wake-up request.
+ */
+class CanResourcePower : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param descriptor Descriptor of the controller.
+     * @param reg        CAN registers.
+     * @param rcc        RCC registers.
+     * @param config     Configuration of the driver resource.
+     */
+    CanResourcePower(CanDescriptor const& descriptor, cpu::reg::Can* reg, cpu::reg::Rcc* rcc, Can::Config const& config);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanResourcePower();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @copydoc eoos::drv::Can::sleep()
+     */
+    bool_t sleep();
+
+    /**
+     * @copydoc eoos::drv::Can::wakeUp()
+     */
+    bool_t wakeUp();
+
+    /**
+     * @copydoc eoos::drv::Can::isSleeping()
+     */
+    bool_t isSleeping() const;
+
+    /**
+     * @copydoc eoos::drv::Can::getWakeUpLatency()
+     */
+    uint32_t getWakeUpLatency() const;
+
+    /**
+     * @copydoc eoos::drv::Can::idle()
+     */
+    bool_t idle();
+
+    /**
+     * @copydoc eoos::drv::Can::getGatedTime()
+     */
+    uint64_t getGatedTime();
+
+    /**
+     * @brief Handles the wake-up and the sleep acknowledge interrupts.
+     *
+     * The function is called by the status change interrupt.
+     */
+    void handleInterrupt();
+
+    /**
+     * @brief Handles a frame received.
+     *
+     * The function is called by the RX FIFO interrupts.
+     */
+    void handleFrame();
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Resumes the normal mode.
+     */
+    void resume();
+
+    /**
+     * @brief Tests if the controller is idle to gate the clock.
+     *
+     * @return True if the controller is in the sleep mode and has no pending transmission.
+     */
+    bool_t isIdle();
+
+    /**
+     * @brief Gates the peripheral clock.
+     */
+    void gate();
+
+    /**
+     * @brief Ungates the peripheral clock.
+     */
+    void ungate();
+
+    /**
+     * @brief Wake-up interrupt bit of CAN_MSR.
+     */
+    static const uint32_t MSR_WKUI_MASK = 0x00000008;
+
+    /**
+     * @brief Sleep acknowledge interrupt bit of CAN_MSR.
+     */
+    static const uint32_t MSR_SLAKI_MASK = 0x00000010;
+
+    /**
+     * @brief Descriptor of the controller.
+     */
+    CanDescriptor const& descriptor_;
+
+    /**
+     * @brief CAN registers.
+     */
+    cpu::reg::Can* reg_;
+
+    /**
+     * @brief RCC registers.
+     */
+    cpu::reg::Rcc* rcc_;
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase* timebase_;
+
+    /**
+     * @brief Idle time in microseconds to gate the clock.
+     */
+    uint32_t idleTimeout_;
+
+    /**
+     * @brief Clock gating guard.
+     */
+    sys::Mutex mutex_;
+
+    /**
+     * @brief Sleep mode is requested.
+     */
+    bool_t volatile isSleep_;
+
+    /**
+     * @brief Wake-up latency is being measured.
+     */
+    bool_t volatile isMeasuring_;
+
+    /**
+     * @brief Time of the last wake-up.
+     */
+    uint32_t volatile wakeUpTime_;
+
+    /**
+     * @brief Measured latency of the last wake-up.
+     */
+    uint32_t volatile latency_;
+
+    /**
+     * @brief The clock is gated.
+     */
+    bool_t volatile isGated_;
+
+    /**
+     * @brief The controller is idle.
+     */
+    bool_t isIdle_;
+
+    /**
+     * @brief Time of the idle start.
+     */
+    uint32_t idleTime_;
+
+    /**
+     * @brief Time of the clock gating.
+     */
+    uint32_t gateTime_;
+
+    /**
+     * @brief Total time of the clock gated.
+     */
+    uint64_t gatedTime_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRESOURCEPOWER_HPP_
@@ -9,7 +9,14 @@
 #include "lib.NonCopyable.hpp"
 #include "lib.NoAllocator.hpp"
 #include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
 #include "drv.CanResourceRxFifo.hpp"
+#include "drv.CanResourcePower.hpp"
+#include "drv.CanDescriptor.hpp"
+#include "drv.CanRecorder.hpp"
+#include "drv.CanMonitor.hpp"
+#include "drv.CanRouter.hpp"
+#include "drv.CanResourceRxWorker.hpp"
 #include "sys.Mutex.hpp"
 
 namespace eoos
@@ -30,11 +37,14 @@ public:
     /**
      * @brief Constructor.
      *
-     * @param config Configuration of the driver resource.          
-     * @param reg    CAN registers.
-     * @param svc    Supervisor call to the system.
+     * @param config     Configuration of the driver resource.          
+     * @param descriptor Descriptor of the controller.
+     * @param reg        CAN registers.
+     * @param svc        Supervisor call to the system.
+     * @param power      Low-power resource.
+     * @param event      Event wait resource.
      */
-    CanResourceRx(Can::Config const& config, cpu::reg::Can* reg, api::Supervisor& svc);
+    CanResourceRx(Can::Config const& config, CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event);
     
     /** 
      * @brief Destructor.
@@ -50,11 +60,99 @@ public:
      * @copydoc eoos::drv::Can::receive()
      */
     bool_t receive(Can::Message* message, Can::RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::receive(Frame*,RxFifo)
+     */
+    bool_t receive(Can::Frame* frame, Can::RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::receive(Frame*,RxFifo,int32_t)
+     */
+    bool_t receive(Can::Frame* frame, Can::RxFifo fifo, int32_t consumer);
+
+    /**
+     * @copydoc eoos::drv::Can::cancel()
+     */
+    bool_t cancel(Can::RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::setConsumers()
+     */
+    bool_t setConsumers(Can::RxFifo fifo, int32_t number);
+
+    /**
+     * @copydoc eoos::drv::Can::getLaneDropCounter()
+     */
+    int32_t getLaneDropCounter(Can::RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::receiveAsync()
+     */
+    bool_t receiveAsync(Can::Request* request, Can::RxFifo fifo);
     
     /**
      * @copydoc eoos::drv::Can::setReceiveFilter()
      */
     bool_t setReceiveFilter(Can::RxFilter const& filter);
+
+    /**
+     * @brief Sets a recorder of received messages.
+     *
+     * @param recorder A recorder, or NULLPTR.
+     */
+    void setRecorder(CanRecorder* recorder);
+
+    /**
+     * @brief Sets a monitor of received messages.
+     *
+     * @param monitor A monitor, or NULLPTR.
+     */
+    void setMonitor(CanMonitor* monitor);
+
+    /**
+     * @brief Sets a router of received messages.
+     *
+     * @param router A router, or NULLPTR.
+     */
+    void setRouter(CanRouter* router);
+
+    /**
+     * @copydoc eoos::drv::Can::setHandler()
+     */
+    bool_t setHandler(Can::Handler* handler, Can::RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::inject()
+     *
+     * @note The caller disables the interrupts of the controller.
+     */
+    bool_t inject(Can::Message const& message, Can::RxFifo fifo);
+
+    /**
+     * @brief Disables the FIFO interrupts.
+     */
+    void disable();
+
+    /**
+     * @brief Enables the FIFO interrupts.
+     */
+    void enable();
+
+    /**
+     * @brief Returns RX events present.
+     *
+     * @param events Bitmask of events to test.
+     * @return Bitmask of the RX FIFO events of frames to receive.
+     */
+    uint32_t poll(uint32_t events);
+
+    /**
+     * @brief Handles an RX FIFO interrupt.
+     *
+     * @param fifo RX FIFO.
+     */
+    void handleInterrupt(Can::RxFifo fifo);
     
 protected:
 
@@ -68,6 +166,14 @@ private:
      * @return true if object has been constructed successfully.
      */
     bool_t construct();
+
+    /**
+     * @brief Returns RX FIFO.
+     *
+     * @param fifo RX FIFO index.
+     * @return RX FIFO, or NULLPTR if the index is wrong.
+     */
+    CanResourceRxFifo* getFifo(Can::RxFifo fifo);
     
     /**
      * @brief CAN registers.
@@ -79,11 +185,26 @@ private:
      */
     sys::Mutex mutex_;
 
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER == 1
+    /**
+     * @brief RX worker thread.
+     */
+    CanResourceRxWorker worker_;
+    #endif
+
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
     /**
-     * @brief RX FIFOs.
+     * @brief RX FIFO 0.
      */        
     CanResourceRxFifo fifo0_;
+    #endif
+
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    /**
+     * @brief RX FIFO 1.
+     */        
     CanResourceRxFifo fifo1_;
+    #endif
 
 };
 
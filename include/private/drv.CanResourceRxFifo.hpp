@@ -11,18 +11,26 @@
 #include "api.Supervisor.hpp"
 #include "api.Runnable.hpp"
 #include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+#include "drv.CanRecorder.hpp"
+#include "drv.CanMonitor.hpp"
+#include "drv.CanRouter.hpp"
+#include "drv.CanResourceRxQueue.hpp"
+#include "drv.CanResourceRxLane.hpp"
+#include "drv.CanResourcePower.hpp"
+#include "drv.CanResourceEvent.hpp"
+#include "drv.CanDescriptor.hpp"
 #include "lib.UniquePointer.hpp"
-#include "lib.Fifo.hpp"
-#include "sys.Mutex.hpp"
 #include "sys.Semaphore.hpp"
 #include "cpu.Registers.hpp"
-#include "cpu.Interrupt.hpp"
 
 namespace eoos
 {
 namespace drv
 {
 
+class CanResourceRxWorker;
+
 /**
  * @class CanResourceRxFifo
  * @brief CAN RX HW FIFO.
@@ -38,15 +46,25 @@ public:
      */    
     static const int32_t NUMBER_OF_RX_FIFOS = 2;
 
+    /**
+     * @brief Number of frames in SW FIFO.
+     *
+     * @note The number equals three mailboxs in HW FIFO.
+     */    
+    static const int32_t NUMBER_OF_FRAMES_IN_FIFO = 3;
+
     /**
      * @brief Constructor.
      *
      * @param number FIFO RX index.   
      * @param isLocked FIFO locked mode flag.     
+     * @param descriptor Descriptor of the controller.
      * @param reg CAN registers.
      * @param svc Supervisor call to the system.     
+     * @param power Low-power resource.
+     * @param event Event wait resource.
      */
-    CanResourceRxFifo(Can::RxFifo index, bool_t isLocked, cpu::reg::Can* reg, api::Supervisor& svc);
+    CanResourceRxFifo(Can::RxFifo index, bool_t isLocked, CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event);
     
     /** 
      * @brief Destructor.
@@ -59,16 +77,124 @@ public:
     virtual bool_t isConstructed() const;
     
     /**
-     * @brief Receives a message.
+     * @brief Receives a frame.
+     *
+     * The function receives a frame to the passed frame structure.
+     * If no frames in receiving buffers, the function waits till
+     * a frame comes. The function is lock-free for any number of callers.
+     *
+     * @param frame A frame structure to receive to it.
+     * @return True if a frame is received successfully, or false if the FIFO is received by requests.
+     */
+    bool_t receive(Can::Frame* frame);
+
+    /**
+     * @brief Receives a frame of a consumer.
+     *
+     * @param frame    A frame structure to receive to it.
+     * @param consumer A consumer index.
+     * @return True if a frame is received successfully.
+     */
+    bool_t receive(Can::Frame* frame, int32_t consumer);
+
+    /**
+     * @brief Cancels a reception of the receive function.
+     *
+     * @return True if the reception is canceled, or false if the FIFO is received by requests.
+     */
+    bool_t cancel();
+
+    /**
+     * @copydoc eoos::drv::Can::setConsumers()
+     */
+    bool_t setConsumers(int32_t number);
+
+    /**
+     * @copydoc eoos::drv::Can::getLaneDropCounter()
+     */
+    int32_t getLaneDropCounter() const;
+
+    /**
+     * @copydoc eoos::drv::Can::receiveAsync()
+     *
+     * @note The request is not submitted if the FIFO is received by the receive function.
+     */
+    bool_t receiveAsync(Can::Request* request);
+
+    /**
+     * @brief Sets a recorder of received messages.
+     *
+     * @param recorder A recorder, or NULLPTR.
+     */
+    void setRecorder(CanRecorder* recorder);
+
+    /**
+     * @brief Sets a monitor of received messages.
+     *
+     * @param monitor A monitor, or NULLPTR.
+     */
+    void setMonitor(CanMonitor* monitor);
+
+    /**
+     * @brief Sets a router of received messages.
+     *
+     * @param router A router, or NULLPTR.
+     */
+    void setRouter(CanRouter* router);
+
+    /**
+     * @brief Sets the worker which frames are passed to.
+     *
+     * @param worker A worker, or NULLPTR to pass frames to the receive function.
+     */
+    void setWorker(CanResourceRxWorker* worker);
+
+    /**
+     * @brief Gets a frame if the SW FIFO is not empty.
+     *
+     * @param frame A frame structure to get to it.
+     * @return True if a frame is got.
+     */
+    bool_t get(Can::Frame* frame);
+
+    /**
+     * @brief Tests if the SW FIFO is empty.
+     *
+     * @return True if no frame.
+     */
+    bool_t isEmpty() const;
+
+    /**
+     * @brief Tests if a frame can be received by the receive function.
+     *
+     * @return True if the SW FIFO is not empty and has no worker.
+     */
+    bool_t isReceivable() const;
+
+    /**
+     * @brief Injects a frame as it has been received by the hardware.
      *
-     * The function receives a message to the passed message structure.
-     * If no messages in receiving buffers, the function waits till
-     * a message comes. 
+     * @note The caller disables the interrupts of the controller, which share the recorder, monitor and router with the FIFO.
      *
-     * @param message A message structure to receive to it.
-     * @return True if a message is received successfully.
+     * @param frame A frame to inject.
+     * @return True if the frame is injected, or false if the FIFO is full, or a lane drops the frame.
      */
-    bool_t receive(Can::Message* message);
+    bool_t inject(Can::Frame const& frame);
+
+    /**
+     * @brief Disables the FIFO interrupt.
+     */
+    void disable();
+
+    /**
+     * @brief Enables the FIFO interrupt.
+     */
+    void enable();
+
+    /**
+     * @brief Handles the FIFO interrupt.
+     */
+    void handleInterrupt();
         
 protected:
 
@@ -94,31 +220,58 @@ private:
      * @return true if interrupt has been initialized successfully.
      */    
     bool_t initializeInterrupt();
-    
+
     /**
-     * @enum Exception
-     * @brief CAN Exception numbers.
-     */    
-    enum Exception
-    {
-        EXCEPTION_CAN1_RX0 = cpu::Interrupt<lib::NoAllocator>::EXCEPTION_USB_LP_CAN1_RX0, ///< FIFO 0 interrupt
-        EXCEPTION_CAN1_RX1 = cpu::Interrupt<lib::NoAllocator>::EXCEPTION_CAN1_RX1,        ///< FIFO 1 interrupt
-    };
-    
+     * @brief Puts a received frame to SW FIFO and wakes up its consumer.
+     *
+     * @param frame       A received frame.
+     * @param isInterrupt The function is called from the FIFO interrupt.
+     * @return True if the frame is passed to the router, a request, a lane, or SW FIFO.
+     */
+    bool_t put(Can::Frame const& frame, bool_t isInterrupt);
+
     /**
-     * @brief Number of TX mailboxs.
-     */    
-    static const int32_t NUMBER_OF_RX_MAILBOXS_IN_FIFO = 3;
-    
+     * @brief Wakes up a consumer of a frame put.
+     *
+     * @param isInterrupt The function is called from the FIFO interrupt.
+     */
+    void wake(bool_t isInterrupt);
+
     /**
-     * @brief SW FIFO.
+     * @brief Binds the FIFO to a way of reception on the first reception.
+     *
+     * A frame taken by a request has no semaphore count taken, so a receive function
+     * blocked on the semaphore would wake up to no frame if both the ways were used.
+     *
+     * @param reception A way of reception.
+     * @return True if the FIFO is received by the way.
+     */
+    bool_t bind(int32_t reception);
+
+    /**
+     * @brief The FIFO is not received yet.
+     */
+    static const int32_t RECEPTION_NONE = 0;
+
+    /**
+     * @brief The FIFO is received by the receive function.
+     */
+    static const int32_t RECEPTION_SYNC = 1;
+
+    /**
+     * @brief The FIFO is received by requests.
      */
-    lib::Fifo<Can::Message,NUMBER_OF_RX_MAILBOXS_IN_FIFO,lib::NoAllocator> fifo_;
+    static const int32_t RECEPTION_ASYNC = 2;
+
+    /**
+     * @brief Identifier and IDE bits of an identifier word.
+     */
+    static const uint32_t KEY_MASK = 0xFFFFFFFC;
     
     /**
-     * @brief This resource mutex.
+     * @brief SW FIFO.
      */
-    sys::Mutex mutex_;
+    CanResourceRxQueue<NUMBER_OF_FRAMES_IN_FIFO> fifo_;
     
     /**
      * @brief RX complite semaphore.
@@ -129,6 +282,11 @@ private:
      * @brief CAN FIFO index.
      */    
     Can::RxFifo index_;
+
+    /**
+     * @brief Descriptor of the controller.
+     */
+    CanDescriptor const& descriptor_;
         
     /**
      * @brief CAN registers.
@@ -145,6 +303,73 @@ private:
      */
     lib::UniquePointer<api::CpuInterrupt> int_;
 
+    /**
+     * @brief Recorder of received messages.
+     */
+    CanRecorder* volatile recorder_;
+
+    /**
+     * @brief Monitor of received messages.
+     */
+    CanMonitor* volatile monitor_;
+
+    /**
+     * @brief Router of received messages.
+     */
+    CanRouter* volatile router_;
+
+    /**
+     * @brief Worker which frames are passed to.
+     */
+    CanResourceRxWorker* volatile worker_;
+
+    /**
+     * @brief First request waiting for a frame.
+     */
+    Can::Request* head_;
+
+    /**
+     * @brief Last request waiting for a frame.
+     */
+    Can::Request* tail_;
+
+    /**
+     * @brief Way of reception the FIFO is bound to.
+     */
+    int32_t volatile reception_;
+
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+    /**
+     * @brief Lanes of consumers.
+     */
+    CanResourceRxLane lanes_[Can::MAXIMUM_NUMBER_OF_CONSUMERS];
+
+    /**
+     * @brief Number of consumers, or zero if the consumers share SW FIFO.
+     */
+    int32_t volatile numberOfLanes_;
+
+    /**
+     * @brief The number of consumers is set, or a frame has been received.
+     */
+    bool_t volatile isLanesFixed_;
+
+    /**
+     * @brief Frames dropped as the lanes are full.
+     */
+    int32_t volatile laneDrops_;
+    #endif
+
+    /**
+     * @brief Low-power resource.
+     */
+    CanResourcePower& power_;
+
+    /**
+     * @brief Event wait resource.
+     */
+    CanResourceEvent& event_;
+
 };
 
 } // namespace drv
@@ -0,0 +1,100 @@
+/**
+ * @file      drv.CanResourceRxLane.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRESOURCERXLANE_HPP_
+#define DRV_CANRESOURCERXLANE_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+#include "drv.CanResourceRxQueue.hpp"
+#include "sys.Semaphore.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanResourceRxLane
+ * @brief CAN RX consumer lane.
+ *
+ * A lane is the SW FIFO of one consumer of an RX FIFO. The RX FIFO interrupt is the only
+ * producer of a lane, and a consumer waits for its lane only, so consumers do not contend.
+ */
+class CanResourceRxLane : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    CanResourceRxLane();
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanResourceRxLane();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Receives a frame.
+     *
+     * If no frames in the lane, the function waits till a frame comes.
+     *
+     * @param frame A frame structure to receive to it.
+     * @return True if a frame is received successfully.
+     */
+    bool_t receive(Can::Frame* frame);
+
+    /**
+     * @brief Puts a frame and wakes up the consumer.
+     *
+     * @param frame       A received frame.
+     * @param isInterrupt The function is called from the FIFO interrupt.
+     * @return True if the frame is put, or false if the lane is full.
+     */
+    bool_t put(Can::Frame const& frame, bool_t isInterrupt);
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Number of frames in a lane.
+     */
+    static const int32_t NUMBER_OF_FRAMES_IN_LANE = 8;
+
+    /**
+     * @brief SW FIFO of the lane, which keeps older frames if it is full.
+     */
+    CanResourceRxQueue<NUMBER_OF_FRAMES_IN_LANE> fifo_;
+
+    /**
+     * @brief RX complite semaphore.
+     */
+    sys::Semaphore sem_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRESOURCERXLANE_HPP_
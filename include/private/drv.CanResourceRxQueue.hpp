@@ -0,0 +1,302 @@
+/**
+ * @file      drv.CanResourceRxQueue.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRESOURCERXQUEUE_HPP_
+#define DRV_CANRESOURCERXQUEUE_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanResourceRxQueue
+ * @brief Lock-free SW FIFO of received frames.
+ *
+ * The queue is a bounded ring of frames with sequence numbers, which is filled
+ * by one producer and drained by any number of consumers without a lock.
+ * The producer is the RX FIFO interrupt, or a thread injecting frames while
+ * the interrupt is disabled.
+ *
+ * Positions of the ring run modulo a multiple of the length which fits a byte,
+ * and the byte sequence numbers are kept apart from the frames, that keeps
+ * the cells of the frames unpadded.
+ *
+ * @tparam L Queue length, which is two at least.
+ */
+template <int32_t L>
+class CanResourceRxQueue : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @enum Result
+     * @brief Result of putting a frame.
+     */
+    enum Result
+    {
+        RESULT_ADDED       = 0, ///< The frame is added
+        RESULT_OVERWRITTEN = 1, ///< The queue is full, and the frame overwrote the last one
+        RESULT_REJECTED    = 2  ///< The queue is full, and the frame is lost
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param isLocked Locked mode flag, in which a new frame does not overwrite the last one of full queue.
+     */
+    explicit CanResourceRxQueue(bool_t isLocked);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanResourceRxQueue();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Puts a frame by the producer.
+     *
+     * @param frame A frame to put.
+     * @return Result of putting.
+     */
+    Result put(Can::Frame const& frame);
+
+    /**
+     * @brief Gets a frame by a consumer.
+     *
+     * @param frame A frame to get to.
+     * @return True if a frame is got, or false if the queue is empty.
+     */
+    bool_t get(Can::Frame* frame);
+
+    /**
+     * @brief Tests if the queue is full.
+     *
+     * @return True if no free cell for the producer.
+     */
+    bool_t isFull() const;
+
+    /**
+     * @brief Tests if the queue is empty.
+     *
+     * @return True if no frame for consumers.
+     */
+    bool_t isEmpty() const;
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Returns the position next to a position.
+     *
+     * @param position A position.
+     * @return The next position.
+     */
+    static uint32_t getNext(uint32_t position);
+
+    /**
+     * @brief Tests if a sequence number is behind a position.
+     *
+     * @param sequence A sequence number.
+     * @param position A position.
+     * @return True if the sequence number precedes the position.
+     */
+    static bool_t isBehind(uint32_t sequence, uint32_t position);
+
+    /**
+     * @brief Number of positions, which is a multiple of the length.
+     */
+    static const uint32_t NUMBER_OF_POSITIONS = (0x100U / static_cast<uint32_t>(L)) * static_cast<uint32_t>(L);
+
+    /**
+     * @brief Frames.
+     */
+    Can::Frame frame_[L];
+
+    /**
+     * @brief Sequence numbers of frames, which are positions of frames free for producer, or positions plus one if frames are filled.
+     */
+    uint8_t volatile sequence_[L];
+
+    /**
+     * @brief Producer position.
+     */
+    uint8_t volatile head_;
+
+    /**
+     * @brief Consumers position.
+     */
+    uint8_t volatile tail_;
+
+    /**
+     * @brief Locked mode flag.
+     */
+    bool_t isLocked_;
+
+};
+
+template <int32_t L>
+CanResourceRxQueue<L>::CanResourceRxQueue(bool_t isLocked)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , head_( 0 )
+    , tail_( 0 )
+    , isLocked_( isLocked ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+template <int32_t L>
+CanResourceRxQueue<L>::~CanResourceRxQueue()
+{
+}
+
+template <int32_t L>
+bool_t CanResourceRxQueue<L>::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+template <int32_t L>
+EOOS_DRV_CAN_RAMFUNC typename CanResourceRxQueue<L>::Result CanResourceRxQueue<L>::put(Can::Frame const& frame)
+{
+    Result res( RESULT_REJECTED );
+    uint32_t const head( head_ );
+    uint32_t const index( head % static_cast<uint32_t>(L) );
+    if( sequence_[index] == head )
+    {
+        uint32_t const next( getNext(head) );
+        frame_[index] = frame;
+        __sync_synchronize();
+        sequence_[index] = static_cast<uint8_t>(next);
+        head_ = static_cast<uint8_t>(next);
+        res = RESULT_ADDED;
+    }
+    // The last frame is overwritten only if no consumer has claimed it,
+    // which holds as consumers are never executed while the producer is.
+    else if( !isLocked_ && tail_ != head )
+    {
+        uint32_t const last( (head + NUMBER_OF_POSITIONS - 1U) % NUMBER_OF_POSITIONS );
+        frame_[last % static_cast<uint32_t>(L)] = frame;
+        res = RESULT_OVERWRITTEN;
+    }
+    else
+    {
+        res = RESULT_REJECTED;
+    }
+    return res;
+}
+
+template <int32_t L>
+bool_t CanResourceRxQueue<L>::get(Can::Frame* frame)
+{
+    bool_t res( false );
+    uint8_t tail( tail_ );
+    while( true )
+    {
+        uint32_t const index( static_cast<uint32_t>(tail) % static_cast<uint32_t>(L) );
+        uint32_t const next( getNext(tail) );
+        uint32_t const sequence( sequence_[index] );
+        if( sequence == next )
+        {
+            if( __sync_bool_compare_and_swap(&tail_, tail, static_cast<uint8_t>(next)) )
+            {
+                *frame = frame_[index];
+                __sync_synchronize();
+                sequence_[index] = static_cast<uint8_t>( (static_cast<uint32_t>(tail) + static_cast<uint32_t>(L)) % NUMBER_OF_POSITIONS );
+                res = true;
+                break;
+            }
+            tail = tail_;
+        }
+        else if( isBehind(sequence, next) )
+        {
+            // The queue is empty
+            break;
+        }
+        else
+        {
+            // Other consumer has got the frame
+            tail = tail_;
+        }
+    }
+    return res;
+}
+
+template <int32_t L>
+bool_t CanResourceRxQueue<L>::isFull() const
+{
+    uint32_t const head( head_ );
+    return sequence_[head % static_cast<uint32_t>(L)] != head;
+}
+
+template <int32_t L>
+bool_t CanResourceRxQueue<L>::isEmpty() const
+{
+    uint32_t const tail( tail_ );
+    return sequence_[tail % static_cast<uint32_t>(L)] != getNext(tail);
+}
+
+template <int32_t L>
+bool_t CanResourceRxQueue<L>::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        // A frame filled must be told from one free for the next lap, and
+        // a sequence number behind a position from one ahead of it
+        if( L < 2 || static_cast<uint32_t>(L) * 2U >= NUMBER_OF_POSITIONS )
+        {
+            break;
+        }
+        for(int32_t i(0); i<L; i++)
+        {
+            sequence_[i] = static_cast<uint8_t>(i);
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+template <int32_t L>
+EOOS_DRV_CAN_RAMFUNC uint32_t CanResourceRxQueue<L>::getNext(uint32_t position)
+{
+    return (position + 1U) % NUMBER_OF_POSITIONS;
+}
+
+template <int32_t L>
+bool_t CanResourceRxQueue<L>::isBehind(uint32_t sequence, uint32_t position)
+{
+    uint32_t const distance( (position + NUMBER_OF_POSITIONS - sequence) % NUMBER_OF_POSITIONS );
+    return ( distance != 0U && distance < NUMBER_OF_POSITIONS / 2U ) ? true : false;
+}
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRESOURCERXQUEUE_HPP_
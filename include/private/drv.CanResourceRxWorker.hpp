@@ -0,0 +1,164 @@
+/**
+ * @file      drv.CanResourceRxWorker.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRESOURCERXWORKER_HPP_
+#define DRV_CANRESOURCERXWORKER_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "lib.Thread.hpp"
+#include "api.Task.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanResourceRxFifo.hpp"
+#include "sys.Semaphore.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanResourceRxWorker
+ * @brief CAN RX worker thread.
+ *
+ * The worker drains the SW FIFOs which have handlers in batches and passes the batches
+ * to the handlers. The RX FIFO interrupts only copy a frame and notify the worker,
+ * and the worker semaphore is released only if the worker waits, so one wake-up
+ * of the worker handles all the frames received till the FIFOs are empty.
+ */
+class CanResourceRxWorker : public lib::NonCopyable<lib::NoAllocator>, public api::Task
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @brief Maximum number of frames passed to a handler at once, which is all frames of SW FIFO.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_FRAMES_IN_BATCH = CanResourceRxFifo::NUMBER_OF_FRAMES_IN_FIFO;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param priority Priority of the worker thread.
+     */
+    explicit CanResourceRxWorker(int32_t priority);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanResourceRxWorker();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @copydoc eoos::api::Task::start()
+     */
+    virtual void start();
+
+    /**
+     * @copydoc eoos::api::Task::getStackSize()
+     */
+    virtual size_t getStackSize() const;
+
+    /**
+     * @brief Sets a handler of an RX FIFO.
+     *
+     * @param handler A handler, or NULLPTR.
+     * @param fifo    The RX FIFO.
+     * @param index   Index of the RX FIFO.
+     */
+    void setHandler(Can::Handler* handler, CanResourceRxFifo* fifo, Can::RxFifo index);
+
+    /**
+     * @brief Notifies the worker of a frame put to a SW FIFO from an interrupt.
+     */
+    void notifyFromInterrupt();
+
+    /**
+     * @brief Notifies the worker of a frame put to a SW FIFO from a thread.
+     */
+    void notify();
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Passes one batch of each SW FIFO to its handler.
+     *
+     * @return Number of frames passed.
+     */
+    int32_t drain();
+
+    /**
+     * @brief Tests if all the SW FIFOs with handlers are empty.
+     *
+     * @return True if no frame to pass.
+     */
+    bool_t isEmpty();
+
+    /**
+     * @brief Stack size of the thread, which zero is the system default.
+     */
+    static const size_t STACK_SIZE = 0;
+
+    /**
+     * @brief Priority of the thread.
+     */
+    int32_t priority_;
+
+    /**
+     * @brief Notification semaphore.
+     */
+    sys::Semaphore sem_;
+
+    /**
+     * @brief The worker waits for a notification, which is not zero.
+     */
+    uint32_t volatile isIdle_;
+
+    /**
+     * @brief The worker is requested to stop.
+     */
+    bool_t volatile isStopped_;
+
+    /**
+     * @brief RX FIFOs.
+     */
+    CanResourceRxFifo* volatile fifo_[CanResourceRxFifo::NUMBER_OF_RX_FIFOS];
+
+    /**
+     * @brief Handlers of the RX FIFOs.
+     */
+    Can::Handler* volatile handler_[CanResourceRxFifo::NUMBER_OF_RX_FIFOS];
+
+    /**
+     * @brief Frames of a batch.
+     */
+    Can::Frame frames_[MAXIMUM_NUMBER_OF_FRAMES_IN_BATCH];
+
+    /**
+     * @brief Worker thread.
+     */
+    lib::Thread<lib::NoAllocator> thread_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRESOURCERXWORKER_HPP_
@@ -12,7 +12,9 @@
 #include "api.Runnable.hpp"
 #include "lib.UniquePointer.hpp"
 #include "cpu.Registers.hpp"
-#include "cpu.Interrupt.hpp"
+#include "drv.CanResourcePower.hpp"
+#include "drv.CanResourceEvent.hpp"
+#include "drv.CanDescriptor.hpp"
 
 namespace eoos
 {
@@ -34,10 +36,13 @@ public:
     /**
      * @brief Constructor.
      *
+     * @param descriptor Descriptor of the controller.
      * @param reg CAN registers.
      * @param svc Supervisor call to the system.     
+     * @param power Low-power resource.
+     * @param event Event wait resource.
      */
-    CanResourceStatus(cpu::reg::Can* reg, api::Supervisor& svc);
+    CanResourceStatus(CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event);
     
     /** 
      * @brief Destructor.
@@ -48,6 +53,21 @@ public:
      * @copydoc eoos::api::Object::isConstructed()
      */
     virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Disables the status change interrupt.
+     */
+    void disable();
+
+    /**
+     * @brief Enables the status change interrupt.
+     */
+    void enable();
+
+    /**
+     * @brief Handles the status change interrupt.
+     */
+    void handleInterrupt();
             
 protected:
 
@@ -75,13 +95,9 @@ private:
     bool_t initializeInterrupt();
     
     /**
-     * @enum Exception
-     * @brief CAN Exception numbers.
-     */    
-    enum Exception
-    {
-        EXCEPTION_CAN1_SCE = cpu::Interrupt<lib::NoAllocator>::EXCEPTION_CAN1_SCE, ///< Status change error interrupt
-    };
+     * @brief Descriptor of the controller.
+     */
+    CanDescriptor const& descriptor_;
 
     /**
      * @brief CAN registers.
@@ -92,6 +108,16 @@ private:
      * @brief Supervisor call to the system.
      */        
     api::Supervisor& svc_;
+
+    /**
+     * @brief Low-power resource.
+     */
+    CanResourcePower& power_;
+
+    /**
+     * @brief Event wait resource.
+     */
+    CanResourceEvent& event_;
     
     /**
      * @brief Target CPU interrupt resource.
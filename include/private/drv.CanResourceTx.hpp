@@ -10,10 +10,12 @@
 #include "lib.NoAllocator.hpp"
 #include "api.Supervisor.hpp"
 #include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
 #include "drv.CanResourceTxMailbox.hpp"
 #include "drv.CanResourceTxMailboxRoutine.hpp"
-#include "cpu.Interrupt.hpp"
-#include "sys.Mutex.hpp"
+#include "drv.CanResourcePower.hpp"
+#include "drv.CanResourceEvent.hpp"
+#include "drv.CanDescriptor.hpp"
 #include "sys.Semaphore.hpp"
 #include "lib.UniquePointer.hpp"
 
@@ -35,10 +37,13 @@ public:
     /**
      * @brief Constructor.
      *
-     * @param reg CAN registers.
-     * @param svc Supervisor call to the system.
+     * @param descriptor Descriptor of the controller.
+     * @param reg        CAN registers.
+     * @param svc        Supervisor call to the system.
+     * @param power      Low-power resource.
+     * @param event      Event wait resource.
      */
-    CanResourceTx(cpu::reg::Can* reg, api::Supervisor& svc);
+    CanResourceTx(CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event);
     
     /** 
      * @brief Destructor.
@@ -55,6 +60,21 @@ public:
      */
     bool_t transmit(Can::Message const& message);
 
+    /**
+     * @copydoc eoos::drv::Can::transmit(Frame const&)
+     */
+    bool_t transmit(Can::Frame const& frame);
+
+    /**
+     * @copydoc eoos::drv::Can::forward()
+     */
+    bool_t forward(Can::Frame const& frame);
+
+    /**
+     * @copydoc eoos::drv::Can::transmitAsync()
+     */
+    bool_t transmitAsync(Can::Request* request);
+
     /**
      * @brief Returns TX error counter.
      *
@@ -62,6 +82,36 @@ public:
      */    
     int32_t getErrorCounter() const;
 
+    /**
+     * @brief Sets a recorder of transmitted messages.
+     *
+     * @param recorder A recorder, or NULLPTR.
+     */
+    void setRecorder(CanRecorder* recorder);
+
+    /**
+     * @brief Disables the transmit interrupt.
+     */
+    void disable();
+
+    /**
+     * @brief Enables the transmit interrupt.
+     */
+    void enable();
+
+    /**
+     * @brief Returns TX events present.
+     *
+     * @param events Bitmask of events to test.
+     * @return The TX event if a TX mailbox is empty.
+     */
+    uint32_t poll(uint32_t events);
+
+    /**
+     * @brief Handles the TX interrupt.
+     */
+    void handleInterrupt();
+
 protected:
 
     using Parent::setConstructed;
@@ -74,6 +124,21 @@ private:
      * @return true if object has been constructed successfully.
      */
     bool_t construct();
+
+    /**
+     * @brief Reserves a free mailbox and waits for it if no mailbox is free.
+     *
+     * @return True if a mailbox is reserved.
+     */
+    bool_t reserve();
+
+    /**
+     * @brief Puts a frame to the first empty mailbox.
+     *
+     * @param frame A frame to transmit.
+     * @return True if a mailbox is set.
+     */
+    bool_t put(Can::Frame const& frame);
     
     /**
      * @brief Initializes the hardware.
@@ -87,20 +152,16 @@ private:
      */
     void deinitialize();    
         
-    /**
-     * @enum Exception
-     * @brief CAN Exception numbers.
-     */    
-    enum Exception
-    {
-        EXCEPTION_CAN1_TX  = cpu::Interrupt<lib::NoAllocator>::EXCEPTION_USB_HP_CAN1_TX,  ///< Transmit interrupt
-    };
-    
     /**
      * @brief Number of TX mailboxs.
      */    
     static const int32_t NUMBER_OF_TX_MAILBOXS = CanResourceTxMailbox::NUMBER_OF_TX_MAILBOXS;
     
+    /**
+     * @brief Descriptor of the controller.
+     */
+    CanDescriptor const& descriptor_;
+
     /**
      * @brief CAN registers.
      */
@@ -112,9 +173,14 @@ private:
     api::Supervisor& svc_;
 
     /**
-     * @brief This resource mutex.
+     * @brief Low-power resource.
+     */
+    CanResourcePower& power_;
+
+    /**
+     * @brief Event wait resource.
      */
-    sys::Mutex mutex_;
+    CanResourceEvent& event_;
 
     /**
      * @brief TX mailboxs.
@@ -124,6 +190,7 @@ private:
     CanResourceTxMailbox  mailbox2_;
     CanResourceTxMailbox* mailbox_[NUMBER_OF_TX_MAILBOXS];
 
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
     /**
      * @brief TX complite semaphore.
      */    
@@ -138,6 +205,7 @@ private:
      * @brief Target CPU interrupt routine.
      */        
     CanResourceTxMailboxRoutine mailboxIsr_;
+    #endif
 
 };
 
@@ -9,6 +9,8 @@
 #include "lib.NonCopyable.hpp"
 #include "lib.NoAllocator.hpp"
 #include "drv.Can.hpp"
+#include "drv.CanDefinitions.hpp"
+#include "drv.CanRecorder.hpp"
 #include "cpu.Registers.hpp"
 
 namespace eoos
@@ -50,12 +52,20 @@ public:
     virtual bool_t isConstructed() const;
     
     /**
-     * @brief Initiates the transmission of a message.
+     * @brief Initiates the transmission of a frame.
      *
-     * @param message A message to tramsmit.
+     * @param frame A frame to tramsmit.
      * @return True if a transmition is initialied.     
      */
-    bool_t transmit(Can::Message const& message);
+    bool_t transmit(Can::Frame const& frame);
+
+    /**
+     * @brief Initiates the transmission of an asynchronous request.
+     *
+     * @param request A request to tramsmit, which is completed by the interrupt routine.
+     * @return True if a transmition is initialied.
+     */
+    bool_t transmit(Can::Request* request);
     
     /**
      * @brief Returns TX error counter.
@@ -64,6 +74,20 @@ public:
      */    
     int32_t getErrorCounter() const;
 
+    /**
+     * @brief Claims the mailbox for exclusive use by a caller.
+     *
+     * The function does not block, and it is callable from threads and interrupts.
+     *
+     * @return True if the mailbox is claimed, or false if it is claimed by other caller.
+     */
+    bool_t claim();
+
+    /**
+     * @brief Releases the mailbox claimed.
+     */
+    void release();
+
     /**
      * @brief Tests if the mailbox is ready to transmit.
      *
@@ -74,11 +98,28 @@ public:
     /**
      * @brief Routines interrupt.
      *
-     * @return True is interrupt is routined.
+     * A mailbox loaded stays busy till its completion is routined, even if the hardware
+     * has already set it empty, so one load is completed by one routine.
+     *
+     * @return True if a transmission loaded is completed.
      */    
     bool_t routine();
 
+    /**
+     * @brief Sets a recorder of transmitted messages.
+     *
+     * @param recorder A recorder, or NULLPTR.
+     */
+    void setRecorder(CanRecorder* recorder);
+
 private:
+
+    /**
+     * @brief Loads a frame to the mailbox and requests its transmission.
+     *
+     * @param frame A frame to tramsmit.
+     */
+    void load(Can::Frame const& frame);
     
     /**
      * @brief Fixs the mailbox transmition status in internal state.
@@ -99,6 +140,16 @@ private:
      */    
     void clearRequestStatus();
 
+    /**
+     * @brief Records the transmitted frame from the mailbox registers.
+     */
+    void recordFrame();
+
+    /**
+     * @brief Completes the asynchronous request in transmission.
+     */
+    void completeRequest();
+
     /**
      * @brief Transmit request status.
      */
@@ -135,10 +186,32 @@ private:
      */    
     RequestStatus requestStatus_;
     
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS == 1
     /**
      * @brief Error counter.
      */
     uint32_t errorCounter_;
+    #endif
+
+    /**
+     * @brief Recorder of transmitted messages.
+     */
+    CanRecorder* volatile recorder_;
+
+    /**
+     * @brief Asynchronous request in transmission.
+     */
+    Can::Request* volatile request_;
+
+    /**
+     * @brief The mailbox is loaded and its completion is not routined.
+     */
+    bool_t volatile isLoaded_;
+
+    /**
+     * @brief Claim flag.
+     */
+    uint32_t volatile claim_;
 
 };
 
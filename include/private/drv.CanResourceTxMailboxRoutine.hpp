@@ -9,6 +9,7 @@
 #include "lib.NonCopyable.hpp"
 #include "lib.NoAllocator.hpp"
 #include "drv.CanResourceTxMailbox.hpp"
+#include "drv.CanResourceEvent.hpp"
 #include "sys.Semaphore.hpp"
 
 namespace eoos
@@ -19,6 +20,11 @@ namespace drv
 /**
  * @class CanResourceTxMailboxRoutine
  * @brief CAN device interrupt TX resource.
+ *
+ * Every load of a mailbox takes one reservation of the free mailboxes, and the completion
+ * of the load returns it. Synchronous transmissions wait for a reservation on the semaphore,
+ * which only wakes them up on completions, and asynchronous requests are queued till
+ * a reservation is taken, so the free mailboxes are never counted twice.
  */
 class CanResourceTxMailboxRoutine : public lib::NonCopyable<lib::NoAllocator>, public api::Runnable
 {
@@ -29,9 +35,11 @@ public:
     /**
      * @brief Constructor.
      *
-     * @param mailbox TX mailboxs.
+     * @param mailbox    TX mailboxs.
+     * @param mailboxSem TX complite semaphore.
+     * @param event      Event wait resource.
      */
-    CanResourceTxMailboxRoutine(CanResourceTxMailbox** mailbox, sys::Semaphore& mailboxSem);
+    CanResourceTxMailboxRoutine(CanResourceTxMailbox** mailbox, sys::Semaphore& mailboxSem, CanResourceEvent& event);
     
     /** 
      * @brief Destructor.
@@ -42,6 +50,35 @@ public:
      * @copydoc eoos::api::Object::isConstructed()
      */
     virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Submits an asynchronous request.
+     *
+     * The request is queued, and the queue is put to the free mailboxes in order.
+     * The function is called with the TX interrupt locked out, or by the interrupt.
+     *
+     * @param request A request to transmit.
+     */
+    void submit(Can::Request* request);
+
+    /**
+     * @brief Reserves a free mailbox.
+     *
+     * The function does not block, and it is callable from threads and interrupts.
+     *
+     * @return True if a mailbox is reserved.
+     */
+    bool_t reserve();
+
+    /**
+     * @brief Returns a reservation which has not been loaded to a mailbox.
+     */
+    void unreserve();
+
+    /**
+     * @brief Handles the TX interrupt.
+     */
+    void handleInterrupt();
     
 protected:
 
@@ -60,6 +97,28 @@ private:
      * @return true if object has been constructed successfully.
      */
     bool_t construct();
+
+    /**
+     * @brief Puts the queued requests to the free mailboxes.
+     */
+    void drain();
+
+    /**
+     * @brief Puts a request to an empty mailbox.
+     *
+     * @param request A request to transmit.
+     * @return True if a mailbox is set.
+     */
+    bool_t load(Can::Request* request);
+
+    /**
+     * @brief Puts a request to a mailbox.
+     *
+     * @param mailbox A mailbox.
+     * @param request A request to transmit.
+     * @return True if the mailbox is set.
+     */
+    static bool_t put(CanResourceTxMailbox* mailbox, Can::Request* request);
     
     /**
      * @brief Number of TX mailboxs.
@@ -76,6 +135,26 @@ private:
      */    
     sys::Semaphore& mailboxSem_;
 
+    /**
+     * @brief Event wait resource.
+     */
+    CanResourceEvent& event_;
+
+    /**
+     * @brief First queued request.
+     */
+    Can::Request* head_;
+
+    /**
+     * @brief Last queued request.
+     */
+    Can::Request* tail_;
+
+    /**
+     * @brief Number of free mailboxes which are not reserved.
+     */
+    int32_t volatile free_;
+
 };
 
 } // namespace drv
@@ -13,6 +13,11 @@ namespace eoos
 namespace drv
 {
 
+class CanRecorder;
+class CanMonitor;
+class CanRouter;
+class CanTimebase;
+
 /**
  * @class Can
  * @brief Controller area network (CAN) device driver.
@@ -27,7 +32,8 @@ public:
      */
     enum Number
     {
-        NUMBER_CAN1 = 0
+        NUMBER_CAN1 = 0, ///< CAN1
+        NUMBER_CAN2 = 1  ///< CAN2 of a controller described by the target or a host model
     };
     
     /**
@@ -72,7 +78,9 @@ public:
             uint32_t       : 2;
             uint32_t txfp  : 1;     ///< Transmit FIFO priority             (reset value is 0)
             uint32_t rflm  : 1;     ///< Receive FIFO locked mode           (reset value is 0)
-            uint32_t       : 12;
+            uint32_t       : 1;
+            uint32_t awum  : 1;     ///< Automatic wake-up mode             (reset value is 0)
+            uint32_t       : 10;
             uint32_t dbf   : 1;     ///< CAN RX and TX frozen during debug  (reset value is 1)
             uint32_t       : 15;
 
@@ -96,13 +104,22 @@ public:
     /**
      * @struct Config
      * @brief Configure CAN driver resource.
+     *
+     * If a timebase is given, each step of the controller initialization is limited by
+     * the time of the timeout, otherwise it is limited by a number of register polls.
+     * The asynchronous initialization requires the timebase.
      */    
     struct Config
     {
-        Number      number;
-        BitRate     bitRate;
-        SamplePoint samplePoint;
-        Reg         reg;
+        Number       number;
+        BitRate      bitRate;
+        SamplePoint  samplePoint;
+        Reg          reg;
+        CanTimebase* timebase;       ///< Time source of the initialization, or NULLPTR
+        uint32_t     initTimeout;    ///< Timeout of an initialization step in microseconds, or 0 for default
+        bool_t       isAsync;        ///< Initialization returns immediately, and completes on isReady() calls
+        uint32_t     idleTimeout;    ///< Idle time in microseconds in the sleep mode to gate the clock, or 0 to never gate
+        int32_t      workerPriority; ///< Priority of the RX worker thread if the worker is built
     };
     
     /**
@@ -163,6 +180,78 @@ public:
 
     };
     
+    /**
+     * @struct Frame
+     * @brief Compact CAN frame in the hardware mailbox format.
+     *
+     * The frame words are bit-compatible with the mailbox registers, which makes
+     * a frame to be copied to and from the hardware word by word.
+     */
+    struct Frame
+    {
+        static const uint32_t IR_RTR_MASK   = 0x00000002; ///< Remote transmission request
+        static const uint32_t IR_IDE_MASK   = 0x00000004; ///< Identifier extension
+        static const uint32_t IR_EXID_POS   = 3;          ///< Extended identifier of 29 bits position
+        static const uint32_t IR_STID_POS   = 21;         ///< Base identifier of 11 bits position
+        static const uint32_t DTR_DLC_MASK  = 0x0000000F; ///< Data length code
+        static const uint32_t DTR_FMI_POS   = 8;          ///< Filter match index position
+        static const uint32_t DTR_FMI_MASK  = 0x0000FF00; ///< Filter match index
+        static const uint32_t DTR_TIME_POS  = 16;         ///< Message time stamp position
+
+        uint32_t     ir;        ///< Identifier word as CAN_RIxR and CAN_TIxR
+        uint32_t     dtr;       ///< Data length and time stamp word as CAN_RDTxR
+        union
+        {
+            uint64_t v64[1];
+            uint32_t v32[2];
+            uint16_t v16[4];
+            uint8_t  v8[8];
+        } data;                 ///< Data as CAN_RDLxR and CAN_RDHxR
+
+        /**
+         * @brief Packs a message to this frame.
+         *
+         * @param message A message to pack.
+         */
+        void pack(Message const& message);
+
+        /**
+         * @brief Unpacks this frame to a message.
+         *
+         * @param message A message to unpack to.
+         */
+        void unpack(Message* message) const;
+
+        /**
+         * @brief Returns the identifier of this frame.
+         *
+         * @return An identifier of 11 bits or 29 bits.
+         */
+        uint32_t getId() const;
+
+        /**
+         * @brief Tests if this frame has an identifier of 29 bits.
+         *
+         * @return True for extended frame.
+         */
+        bool_t isExtended() const;
+
+        /**
+         * @brief Tests if this frame is a remote request.
+         *
+         * @return True for remote request frame.
+         */
+        bool_t isRemote() const;
+
+        /**
+         * @brief Returns the data length code of this frame.
+         *
+         * @return Number of bytes of data.
+         */
+        uint32_t getDlc() const;
+
+    };
+
     /**
      * @enum RxFifo
      * @brief Specifies the FIFO (0 or 1) from which receiving message will be.
@@ -172,7 +261,85 @@ public:
         RXFIFO_0 = 0,
         RXFIFO_1 = 1
     };    
+
+    static const uint32_t EVENT_RXFIFO_0 = 0x00000001; ///< RX FIFO 0 has a message to receive
+    static const uint32_t EVENT_RXFIFO_1 = 0x00000002; ///< RX FIFO 1 has a message to receive
+    static const uint32_t EVENT_TX       = 0x00000004; ///< A TX mailbox is empty to transmit
+    static const uint32_t EVENT_STATUS   = 0x00000008; ///< Bus state has been changed since the last wait
+    static const uint32_t EVENT_ALL      = 0x0000000F; ///< All the events
+
+    /**
+     * @brief Maximum number of consumers of RX FIFO with their own lanes.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_CONSUMERS = 4;
     
+    /**
+     * @class Handler
+     * @brief Handler of frames received, which is called by the RX worker thread.
+     */
+    class Handler
+    {
+
+    public:
+
+        /**
+         * @brief Destructor.
+         */
+        virtual ~Handler() {}
+
+        /**
+         * @brief Handles a batch of frames received.
+         *
+         * @param frames Frames received in order of reception.
+         * @param number Number of the frames.
+         * @param fifo   RX FIFO of the frames.
+         */
+        virtual void handle(Frame const* frames, int32_t number, RxFifo fifo) = 0;
+
+    };
+
+    struct Request;
+
+    /**
+     * @class Completion
+     * @brief Completion of asynchronous requests.
+     */
+    class Completion
+    {
+
+    public:
+
+        /**
+         * @brief Destructor.
+         */
+        virtual ~Completion() {}
+
+        /**
+         * @brief Completes a request.
+         *
+         * The function is called by the CAN interrupts, so it shall not block,
+         * and the request may be submitted again by it.
+         *
+         * @param request A request completed.
+         */
+        virtual void complete(Request* request) = 0;
+
+    };
+
+    /**
+     * @struct Request
+     * @brief Asynchronous request of a transmission or a reception.
+     *
+     * A request is owned by the driver from its submission till its completion.
+     */
+    struct Request
+    {
+        Frame       frame;      ///< Frame to transmit, or frame received
+        Completion* completion; ///< Completion of the request
+        bool_t      isOk;       ///< The frame has been transmitted or received, which is set on completion
+        Request*    next;       ///< Next request in a driver queue
+    };
+
     /**
      * @struct RxFilter
      * @brief CAN RX message filter initialization structure.
@@ -339,6 +506,28 @@ public:
      */
     virtual bool_t transmit(Message const& message) = 0;
 
+    /**
+     * @brief Initiates the transmission of a frame.
+     *
+     * The function does the same as the message transmission,
+     * but copies the frame to the hardware without conversion.
+     *
+     * @param frame A frame to tramsmit.
+     * @return True if a transmition is initialied.
+     */
+    virtual bool_t transmit(Frame const& frame) = 0;
+
+    /**
+     * @brief Initiates the transmission of a frame if a task is free.
+     *
+     * Unlike the transmission, the function does not wait and does not wake up
+     * the controller, so it is callable from interrupts to forward frames.
+     *
+     * @param frame A frame to tramsmit.
+     * @return True if a transmition is initialied.
+     */
+    virtual bool_t forward(Frame const& frame) = 0;
+
     /**
      * @brief Returns error count of transmission.
      *
@@ -359,6 +548,123 @@ public:
      */
     virtual bool_t receive(Message* message, RxFifo fifo) = 0;
 
+    /**
+     * @brief Receives a frame.
+     *
+     * The function does the same as the message receiving,
+     * but copies the frame as it has been received by the hardware.
+     *
+     * @param frame A frame structure to receive to it.
+     * @param fifo  RX FIFO to receive frame.
+     * @return True if a frame is received successfully.
+     */
+    virtual bool_t receive(Frame* frame, RxFifo fifo) = 0;
+
+    /**
+     * @brief Receives a frame of a consumer.
+     *
+     * The function does the same as the frame receiving, but receives the frames
+     * distributed to the lane of the consumer only.
+     *
+     * @param frame    A frame structure to receive to it.
+     * @param fifo     RX FIFO to receive frame.
+     * @param consumer A consumer index in ranges from 0 to the number of consumers set minus one.
+     * @return True if a frame is received successfully.
+     */
+    virtual bool_t receive(Frame* frame, RxFifo fifo, int32_t consumer) = 0;
+
+    /**
+     * @brief Cancels a reception of RX FIFO.
+     *
+     * A thread waiting in the receive functions without a consumer wakes up,
+     * and the function returns false if no frame is received. If no thread is waiting,
+     * the next call of the receive functions does not wait.
+     *
+     * @param fifo RX FIFO.
+     * @return True if the reception is canceled, or false if RX FIFO is received by requests.
+     */
+    virtual bool_t cancel(RxFifo fifo) = 0;
+
+    /**
+     * @brief Sets a number of consumers of RX FIFO.
+     *
+     * Frames of RX FIFO with consumers are distributed by the RX FIFO interrupt to the lanes
+     * of the consumers by a hash of the identifier, so frames of one identifier are received
+     * by one consumer in order of reception, and the consumers do not contend with each other.
+     * Otherwise, the consumers share the RX FIFO by the receive functions without a consumer,
+     * which take frames in order of reception by any number of threads lock-free.
+     *
+     * @param fifo   RX FIFO.
+     * @param number A number of consumers up to MAXIMUM_NUMBER_OF_CONSUMERS, or 0 to share the RX FIFO.
+     * @return True if the number is set, or false if the consumer lanes are not built,
+     *         or the number has been set, or a frame has been received by RX FIFO.
+     *
+     * @note The number is set once before frames are received, as frames of one identifier
+     *       would be received out of order by two consumers on change.
+     * @note Frames of RX FIFO with consumers go to the lanes only, so the receive functions
+     *       without a consumer get no frame, and the RX FIFO event of wait() is never signaled.
+     *       A thread waiting in the receive functions without a consumer is released by cancel().
+     */
+    virtual bool_t setConsumers(RxFifo fifo, int32_t number) = 0;
+
+    /**
+     * @brief Returns count of frames dropped as the lanes of consumers are full.
+     *
+     * @param fifo RX FIFO.
+     * @return Frames dropped, or -1 if the consumer lanes are not built.
+     */
+    virtual int32_t getLaneDropCounter(RxFifo fifo) = 0;
+
+    /**
+     * @brief Submits an asynchronous transmission.
+     *
+     * The request is queued, and the queued requests are loaded in order of submission
+     * to the free TX mailboxes, which are shared with the synchronous transmissions.
+     * The TX interrupt completes the request when the transmission is finished,
+     * and loads the next queued requests to the mailboxes freed.
+     *
+     * @param request A request with a frame to transmit and a completion.
+     * @return True if the request is submitted, or false if the TX queueing is not built,
+     *         or the controller sleeps.
+     *
+     * @note The function does not wake the controller up, as it may be called by a completion
+     *       from the CAN interrupts, so the controller is woken up by wakeUp() before a submission.
+     */
+    virtual bool_t transmitAsync(Request* request) = 0;
+
+    /**
+     * @brief Submits an asynchronous reception.
+     *
+     * The RX FIFO interrupt completes the request with the next frame received.
+     * If a frame is already received, the function completes the request by itself.
+     * The requests are completed in order of submission.
+     *
+     * @param request A request with a completion.
+     * @param fifo    RX FIFO to receive frame.
+     * @return True if the request is submitted.
+     *
+     * @note A frame is received either by a request or by the receive functions,
+     *       and RX FIFO is bound to the way of its first reception, so the other
+     *       way fails for the RX FIFO.
+     */
+    virtual bool_t receiveAsync(Request* request, RxFifo fifo) = 0;
+
+    /**
+     * @brief Waits for any of events.
+     *
+     * The function returns immediately if an event is present, otherwise it blocks the caller
+     * till an event is signaled by the interrupts, so one task can service the controller
+     * by one call. The events are tested on return, and the status event is cleared by the return.
+     * One task waits at a time.
+     *
+     * @param events Bitmask of EVENT_* values to wait for.
+     * @return Bitmask of the events present, or 0 if an error has been occurred.
+     *
+     * @note The TX event wakes up if the TX queueing is built, and the status event if the status
+     *       handler is built. An RX FIFO with a handler never has the RX event.
+     */
+    virtual uint32_t wait(uint32_t events) = 0;
+
     /**
      * @brief Sets filter for receiving messages.
      *
@@ -367,6 +673,124 @@ public:
      */
     virtual bool_t setReceiveFilter(RxFilter const& filter) = 0;
 
+    /**
+     * @brief Sets a recorder of RX and TX messages.
+     *
+     * @param recorder A recorder to tap messages to, or NULLPTR to stop recording.
+     * @return True if the recorder is set successfully.
+     */
+    virtual bool_t setRecorder(CanRecorder* recorder) = 0;
+
+    /**
+     * @brief Sets a monitor of RX messages.
+     *
+     * @param monitor A monitor to refresh by messages received, or NULLPTR to stop monitoring.
+     * @return True if the monitor is set successfully.
+     */
+    virtual bool_t setMonitor(CanMonitor* monitor) = 0;
+
+    /**
+     * @brief Sets a router of RX messages.
+     *
+     * @param router A router to forward messages received, or NULLPTR to stop routing.
+     * @return True if the router is set successfully.
+     */
+    virtual bool_t setRouter(CanRouter* router) = 0;
+
+    /**
+     * @brief Sets a handler of frames received to RX FIFO.
+     *
+     * The frames of RX FIFO with a handler are passed to the handler by the RX worker thread
+     * and are not received by the receive functions.
+     *
+     * @param handler A handler, or NULLPTR to receive frames by the receive functions.
+     * @param fifo    RX FIFO.
+     * @return True if the handler is set, or false if the worker is not built.
+     */
+    virtual bool_t setHandler(Handler* handler, RxFifo fifo) = 0;
+
+    /**
+     * @brief Injects a message to RX FIFO as it has been received from the bus.
+     *
+     * The message passes all the receiving path of the driver, but unlike the hardware,
+     * the function does not overwrite the last message of full FIFO and fails.
+     *
+     * @param message A message to inject.
+     * @param fifo    RX FIFO to inject message to.
+     * @return True if the message is injected, or false if it is not queued as the FIFO or a consumer lane is full.
+     */
+    virtual bool_t inject(Message const& message, RxFifo fifo) = 0;
+
+    /**
+     * @brief Puts the controller to the sleep mode.
+     *
+     * The controller enters the sleep mode when current bus activity completes.
+     * It wakes up on a transmission, on the wakeUp() call, or on bus activity
+     * if the automatic wake-up mode is set. Waking up keeps the receive filters
+     * and the received messages.
+     *
+     * @return True if the sleep mode is requested.
+     */
+    virtual bool_t sleep() = 0;
+
+    /**
+     * @brief Resumes the controller from the sleep mode.
+     *
+     * @return True if the normal mode is requested.
+     */
+    virtual bool_t wakeUp() = 0;
+
+    /**
+     * @brief Tests if the controller is in the sleep mode.
+     *
+     * @return True if the controller has acknowledged the sleep mode.
+     */
+    virtual bool_t isSleeping() const = 0;
+
+    /**
+     * @brief Returns latency from the last wake-up to the first frame received.
+     *
+     * @return Latency in microseconds, or 0 if no timebase given or no frame received.
+     */
+    virtual uint32_t getWakeUpLatency() const = 0;
+
+    /**
+     * @brief Gates the controller clock if it is idle.
+     *
+     * The function is intended to be called periodically, for example by an idle thread.
+     * The clock is gated if the controller has been in the sleep mode with no pending
+     * transmission for the idle timeout. The clock is ungated on a transmission
+     * or the wakeUp() call. The function does nothing if no timebase or idle timeout given.
+     *
+     * @return True if the clock is gated.
+     */
+    virtual bool_t idle() = 0;
+
+    /**
+     * @brief Returns total time of the controller clock gated.
+     *
+     * @return Time in microseconds.
+     */
+    virtual uint64_t getGatedTime() = 0;
+
+    /**
+     * @brief Tests if the controller is initialized.
+     *
+     * For the asynchronous initialization, the function advances it without waiting,
+     * and it has to be called till it returns true. The function returns false forever
+     * if the initialization has failed by the timeout.
+     *
+     * @return True if the controller is in the normal mode.
+     */
+    virtual bool_t isReady() = 0;
+
+    /**
+     * @brief Returns time of the controller initialization.
+     *
+     * @return Measured time in microseconds, or 0 if no timebase given or the controller is not ready.
+     */
+    virtual uint32_t getInitTime() const = 0;
+
     /**
      * @brief Create the driver resource.
      *
@@ -397,6 +821,57 @@ inline bool_t Can::Message::operator!=(Can::Message const& obj) const
     return (*this == obj) ? false : true;
 }
 
+inline void Can::Frame::pack(Can::Message const& message)
+{
+    uint32_t value( static_cast<uint32_t>(message.id.stid) << IR_STID_POS );
+    if( message.ide )
+    {
+        value |= IR_IDE_MASK | ( static_cast<uint32_t>(message.id.exid) << IR_EXID_POS );
+    }
+    if( message.rtr )
+    {
+        value |= IR_RTR_MASK;
+    }
+    ir = value;
+    dtr = message.dlc & DTR_DLC_MASK;
+    data.v64[0] = message.data.v64[0];
+}
+
+inline void Can::Frame::unpack(Can::Message* message) const
+{
+    message->id.stid = ir >> IR_STID_POS;
+    message->id.exid = ir >> IR_EXID_POS;
+    message->rtr = ( (ir & IR_RTR_MASK) != 0 ) ? true : false;
+    message->ide = ( (ir & IR_IDE_MASK) != 0 ) ? true : false;
+    message->dlc = dtr & DTR_DLC_MASK;
+    message->data.v64[0] = data.v64[0];
+}
+
+inline uint32_t Can::Frame::getId() const
+{
+    uint32_t id( ir >> IR_STID_POS );
+    if( isExtended() )
+    {
+        id = ir >> IR_EXID_POS;
+    }
+    return id;
+}
+
+inline bool_t Can::Frame::isExtended() const
+{
+    return ( (ir & IR_IDE_MASK) != 0 ) ? true : false;
+}
+
+inline bool_t Can::Frame::isRemote() const
+{
+    return ( (ir & IR_RTR_MASK) != 0 ) ? true : false;
+}
+
+inline uint32_t Can::Frame::getDlc() const
+{
+    return dtr & DTR_DLC_MASK;
+}
+
 } // namespace drv
 } // namespace eoos
 #endif // DRV_CAN_HPP_
@@ -0,0 +1,346 @@
+/**
+ * @file      drv.CanIsoTp.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANISOTP_HPP_
+#define DRV_CANISOTP_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanTimebase.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanIsoTp
+ * @brief ISO-TP (ISO 15765-2) transport layer with normal addressing.
+ *
+ * The layer has a static pool of channels, and each channel is a pair of TX and RX
+ * identifiers which segments messages to send and reassembles messages received.
+ * A message to send is segmented directly from the caller buffer, and a message received
+ * is reassembled directly to the channel buffer, so the buffers shall be kept till
+ * the transfers complete.
+ *
+ * The layer does not block, and it is not thread-safe. A caller shall pass every frame
+ * received to handle(), and shall call process() periodically, and it may sleep
+ * for getDelay() microseconds between the calls. Consecutive frames of a block are
+ * transmitted back-to-back if the receiver requests zero STmin.
+ */
+class CanIsoTp : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @enum Status
+     * @brief Status of a transfer.
+     */
+    enum Status
+    {
+        STATUS_IDLE     = 0, ///< No transfer
+        STATUS_BUSY     = 1, ///< A transfer is in progress
+        STATUS_DONE     = 2, ///< A transfer is completed
+        STATUS_TIMEOUT  = 3, ///< A transfer is aborted as no frame in time
+        STATUS_OVERFLOW = 4, ///< A transfer is aborted as the message is too long for the receiver
+        STATUS_SEQUENCE = 5  ///< A transfer is aborted as a wrong sequence number received
+    };
+
+    /**
+     * @struct Address
+     * @brief Addresses of a channel.
+     */
+    struct Address
+    {
+        uint32_t txId;       ///< Identifier of frames to transmit
+        uint32_t rxId;       ///< Identifier of frames to receive
+        bool_t   isExtended; ///< Identifiers are of 29 bits
+    };
+
+    /**
+     * @brief Maximum number of channels.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_CHANNELS = 4;
+
+    /**
+     * @brief Maximum size of a message in bytes.
+     */
+    static const size_t MAXIMUM_MESSAGE_SIZE = 4095;
+
+    /**
+     * @brief Timeout of N_Bs and N_Cr in microseconds.
+     */
+    static const uint32_t TIMEOUT = 1000000;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param can      A driver to transmit frames.
+     * @param timebase Time source of the layer.
+     */
+    CanIsoTp(Can& can, CanTimebase& timebase);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanIsoTp();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Opens a channel.
+     *
+     * @param address   Addresses of the channel.
+     * @param buffer    A buffer to reassemble messages received.
+     * @param size      Size of the buffer in bytes.
+     * @param blockSize Block size to request from a sender, or 0 for no flow control.
+     * @param stMin     Separation time to request from a sender in STmin encoding.
+     * @return Index of the channel, or -1 if no free channel.
+     */
+    int32_t open(Address const& address, uint8_t* buffer, size_t size, uint8_t blockSize = 0, uint8_t stMin = 0);
+
+    /**
+     * @brief Closes a channel and aborts its transfers.
+     *
+     * @param channel Index of the channel.
+     */
+    void close(int32_t channel);
+
+    /**
+     * @brief Starts sending a message.
+     *
+     * A single frame message is transmitted by the function, and a longer one
+     * is transmitted by the function and the following process() calls.
+     *
+     * @param channel Index of the channel.
+     * @param data    Message data, which shall be kept till the transfer completes.
+     * @param size    Message size in bytes.
+     * @return True if the transfer is started, or false if no TX mailbox is free now.
+     */
+    bool_t send(int32_t channel, uint8_t const* data, size_t size);
+
+    /**
+     * @brief Handles a frame received.
+     *
+     * @param frame A frame received.
+     * @return True if the frame is addressed to a channel.
+     */
+    bool_t handle(Can::Frame const& frame);
+
+    /**
+     * @brief Transmits all the frames which time has come and checks timeouts.
+     *
+     * @return Number of frames transmitted.
+     */
+    int32_t process();
+
+    /**
+     * @brief Returns time to the next process() call.
+     *
+     * @return Time in microseconds, or zero if a frame is due, or TIMEOUT if nothing is pending.
+     */
+    uint32_t getDelay();
+
+    /**
+     * @brief Returns status of sending.
+     *
+     * @param channel Index of the channel.
+     * @return Status of the last message to send.
+     */
+    Status getTxStatus(int32_t channel) const;
+
+    /**
+     * @brief Returns status of receiving.
+     *
+     * @param channel Index of the channel.
+     * @return Status of the last message received.
+     */
+    Status getRxStatus(int32_t channel) const;
+
+    /**
+     * @brief Returns size of a message received.
+     *
+     * @param channel Index of the channel.
+     * @return Size in bytes if the status is STATUS_DONE, or zero.
+     */
+    size_t getRxSize(int32_t channel) const;
+
+    /**
+     * @brief Releases a message received to receive next one to the channel buffer.
+     *
+     * @param channel Index of the channel.
+     */
+    void release(int32_t channel);
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @enum Step
+     * @brief Step of sending.
+     */
+    enum Step
+    {
+        STEP_NONE    = 0, ///< Nothing to do
+        STEP_WAIT_FC = 1, ///< Waiting for a flow control frame
+        STEP_SEND_CF = 2  ///< Sending consecutive frames
+    };
+
+    /**
+     * @struct Channel
+     * @brief Channel state.
+     */
+    struct Channel
+    {
+        bool_t         isOpen;       ///< The channel is opened
+        uint32_t       txIr;         ///< Identifier word of frames to transmit
+        uint32_t       rxIr;         ///< Identifier word of frames to receive
+        uint8_t        blockSize;    ///< Block size to request
+        uint8_t        stMin;        ///< Separation time to request
+        Status         txStatus;     ///< Status of sending
+        Step           txStep;       ///< Step of sending
+        uint8_t const* txData;       ///< Message to send
+        size_t         txSize;       ///< Size of the message to send
+        size_t         txOffset;     ///< Offset of the next byte to send
+        uint8_t        txSn;         ///< Sequence number of the next consecutive frame
+        uint8_t        txBlockSize;  ///< Block size requested by a receiver
+        uint8_t        txBlockCount; ///< Consecutive frames sent in the block
+        uint32_t       txStMin;      ///< Separation time requested by a receiver in microseconds
+        uint32_t       txTime;       ///< Time of the next consecutive frame or the flow control timeout
+        Status         rxStatus;     ///< Status of receiving
+        uint8_t*       rxBuffer;     ///< Buffer to reassemble to
+        size_t         rxCapacity;   ///< Size of the buffer
+        size_t         rxSize;       ///< Size of the message receiving
+        size_t         rxOffset;     ///< Offset of the next byte to receive
+        uint8_t        rxSn;         ///< Expected sequence number
+        uint8_t        rxBlockCount; ///< Consecutive frames received in the block
+        uint32_t       rxTime;       ///< Time of the consecutive frame timeout
+        bool_t         isFcPending;  ///< A flow control frame has not been transmitted
+        uint8_t        fcFlag;       ///< Flow status of the pending flow control frame
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Tests if a channel index is of an opened channel.
+     *
+     * @param channel Index of the channel.
+     * @return True if the channel is opened.
+     */
+    bool_t isOpen(int32_t channel) const;
+
+    /**
+     * @brief Handles a frame received to a channel.
+     *
+     * @param ch    The channel.
+     * @param frame A frame received.
+     */
+    void handle(Channel& ch, Can::Frame const& frame);
+
+    /**
+     * @brief Sends consecutive frames which time has come.
+     *
+     * @param ch   The channel.
+     * @param time Current time.
+     * @return Number of frames transmitted.
+     */
+    int32_t sendConsecutive(Channel& ch, uint32_t time);
+
+    /**
+     * @brief Transmits a flow control frame.
+     *
+     * @param ch   The channel.
+     * @param flag Flow status.
+     * @return True if transmitted.
+     */
+    bool_t sendFlowControl(Channel& ch, uint8_t flag);
+
+    /**
+     * @brief Transmits a frame to a channel.
+     *
+     * @param ch     The channel.
+     * @param pci    Protocol control information of one, two or three bytes.
+     * @param size   Size of the protocol control information.
+     * @param data   Data after the protocol control information.
+     * @param length Size of the data.
+     * @return True if transmitted, or false if no TX mailbox is free.
+     */
+    bool_t transmit(Channel& ch, uint8_t const* pci, int32_t size, uint8_t const* data, size_t length);
+
+    /**
+     * @brief Returns an identifier word of the frame format.
+     *
+     * @param id         An identifier.
+     * @param isExtended The identifier is of 29 bits.
+     * @return The identifier word.
+     */
+    static uint32_t toIr(uint32_t id, bool_t isExtended);
+
+    /**
+     * @brief Decodes STmin to microseconds.
+     *
+     * @param stMin STmin value.
+     * @return Separation time in microseconds.
+     */
+    static uint32_t toMicroseconds(uint8_t stMin);
+
+    /**
+     * @brief Tests if a time has come.
+     *
+     * @param time Current time.
+     * @param when A time to test.
+     * @return True if the time has come.
+     */
+    static bool_t isExpired(uint32_t time, uint32_t when);
+
+    static const uint8_t PCI_TYPE_MASK  = 0xF0; ///< Frame type of protocol control information
+    static const uint8_t PCI_VALUE_MASK = 0x0F; ///< Value of protocol control information
+    static const uint8_t PCI_TYPE_SF    = 0x00; ///< Single frame
+    static const uint8_t PCI_TYPE_FF    = 0x10; ///< First frame
+    static const uint8_t PCI_TYPE_CF    = 0x20; ///< Consecutive frame
+    static const uint8_t PCI_TYPE_FC    = 0x30; ///< Flow control frame
+    static const uint8_t FC_CTS         = 0x00; ///< Flow status of continue to send
+    static const uint8_t FC_WAIT        = 0x01; ///< Flow status of wait
+    static const uint8_t FC_OVERFLOW    = 0x02; ///< Flow status of overflow
+    static const size_t  SF_DATA_SIZE   = 7;    ///< Maximum data size of a single frame
+    static const size_t  FF_DATA_SIZE   = 6;    ///< Data size of a first frame
+    static const size_t  CF_DATA_SIZE   = 7;    ///< Maximum data size of a consecutive frame
+    static const uint8_t PADDING        = 0xCC; ///< Frame data byte to pad a frame
+    static const uint32_t IR_KEY_MASK   = 0xFFFFFFFC; ///< Identifier and IDE bits of an identifier word
+
+    /**
+     * @brief Driver to transmit frames.
+     */
+    Can& can_;
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase& timebase_;
+
+    /**
+     * @brief Channels.
+     */
+    Channel channels_[MAXIMUM_NUMBER_OF_CHANNELS];
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANISOTP_HPP_
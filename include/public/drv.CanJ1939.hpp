@@ -0,0 +1,529 @@
+/**
+ * @file      drv.CanJ1939.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANJ1939_HPP_
+#define DRV_CANJ1939_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanTimebase.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanJ1939
+ * @brief SAE J1939 layer of one controller application.
+ *
+ * The layer claims an address, sends and receives messages of up to 1785 bytes
+ * by the BAM and RTS/CTS transport protocol, and dispatches messages received to
+ * handlers by PGN. The receive filters of the driver are programmed from the registered
+ * PGNs, so frames of other PGNs are dropped by the hardware.
+ *
+ * A message to send is transmitted directly from the caller buffer, which shall be kept
+ * till the transfer completes, and a multi-packet message received is reassembled to
+ * a session buffer of a static pool.
+ *
+ * The layer does not block, and it is not thread-safe. A caller shall pass every frame
+ * received to handle(), and shall call process() periodically, and it may sleep
+ * for getDelay() microseconds between the calls.
+ */
+class CanJ1939 : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @struct Id
+     * @brief Decoded 29-bit identifier.
+     */
+    struct Id
+    {
+        uint8_t  priority; ///< Priority from 0 to 7
+        uint32_t pgn;      ///< Parameter group number of 18 bits
+        uint8_t  sa;       ///< Source address
+        uint8_t  da;       ///< Destination address, which is global for PDU2 format
+    };
+
+    /**
+     * @class Handler
+     * @brief Handler of messages received of a PGN.
+     */
+    class Handler
+    {
+
+    public:
+
+        /**
+         * @brief Destructor.
+         */
+        virtual ~Handler() {}
+
+        /**
+         * @brief Handles a message received.
+         *
+         * @param id   Identifier of the message, which PGN is of the transported message for multi-packet one.
+         * @param data Message data, which is valid during the call only.
+         * @param size Message size in bytes.
+         */
+        virtual void handle(Id const& id, uint8_t const* data, size_t size) = 0;
+
+    };
+
+    /**
+     * @enum Status
+     * @brief Status of a transfer.
+     */
+    enum Status
+    {
+        STATUS_IDLE    = 0, ///< No transfer
+        STATUS_BUSY    = 1, ///< A transfer is in progress
+        STATUS_DONE    = 2, ///< A transfer is completed
+        STATUS_TIMEOUT = 3, ///< A transfer is aborted as no frame in time
+        STATUS_ABORTED = 4  ///< A transfer is aborted by the receiver
+    };
+
+    /**
+     * @enum Claim
+     * @brief State of the address claim.
+     */
+    enum Claim
+    {
+        CLAIM_NONE     = 0, ///< No address is claimed
+        CLAIM_PENDING  = 1, ///< The address is claimed, and contention is waited for
+        CLAIM_DONE     = 2, ///< The address is claimed successfully
+        CLAIM_FAILED   = 3  ///< No address could be claimed
+    };
+
+    static const uint8_t  ADDRESS_GLOBAL = 0xFF; ///< Global destination address
+    static const uint8_t  ADDRESS_NULL   = 0xFE; ///< Null address of a node which cannot claim an address
+    static const uint32_t PGN_REQUEST    = 0xEA00; ///< Request
+    static const uint32_t PGN_TP_DT      = 0xEB00; ///< Transport protocol data transfer
+    static const uint32_t PGN_TP_CM      = 0xEC00; ///< Transport protocol connection management
+    static const uint32_t PGN_ADDRESS    = 0xEE00; ///< Address claimed
+
+    /**
+     * @brief Maximum size of a message in bytes.
+     */
+    static const size_t MAXIMUM_MESSAGE_SIZE = 1785;
+
+    /**
+     * @brief Maximum number of concurrent TX and RX sessions each.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_SESSIONS = 2;
+
+    /**
+     * @brief Maximum number of PGNs to register.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_PGNS = 8;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param can      A driver to transmit frames.
+     * @param timebase Time source of the layer.
+     * @param name     NAME of the controller application.
+     * @param address  Preferred address.
+     */
+    CanJ1939(Can& can, CanTimebase& timebase, uint64_t name, uint8_t address);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanJ1939();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Decodes an identifier of a frame.
+     *
+     * @param frame A frame.
+     * @param id    An identifier to decode to.
+     * @return True if the frame has an extended identifier.
+     */
+    static bool_t decode(Can::Frame const& frame, Id* id);
+
+    /**
+     * @brief Encodes an identifier to a frame.
+     *
+     * @param id    An identifier.
+     * @param frame A frame to encode to.
+     */
+    static void encode(Id const& id, Can::Frame* frame);
+
+    /**
+     * @brief Registers a handler of a PGN.
+     *
+     * @param pgn     A PGN.
+     * @param handler A handler of the messages.
+     * @return True if registered.
+     */
+    bool_t setHandler(uint32_t pgn, Handler& handler);
+
+    /**
+     * @brief Programs the receive filters of the driver from the registered PGNs.
+     *
+     * The filters from the first one are set in the 32-bit mask mode, and each filter
+     * passes one PGN of the registered and the network management and transport ones.
+     *
+     * @param fifo  RX FIFO which the layer receives from.
+     * @param index Index of the first filter to use.
+     * @return True if all the filters are set.
+     */
+    bool_t setReceiveFilters(Can::RxFilter::Fifo fifo, uint32_t index);
+
+    /**
+     * @brief Claims the preferred address.
+     *
+     * The address is used after no contention for 250 ms.
+     * If the NAME is arbitrary address capable, other addresses from 128 to 247
+     * are claimed on contention.
+     *
+     * @return True if the claim is transmitted, or false if it is transmitted by process() calls.
+     */
+    bool_t claim();
+
+    /**
+     * @brief Returns state of the address claim.
+     *
+     * @return The state.
+     */
+    Claim getClaim() const;
+
+    /**
+     * @brief Returns the address.
+     *
+     * @return The claimed address, or ADDRESS_NULL.
+     */
+    uint8_t getAddress() const;
+
+    /**
+     * @brief Starts sending a message.
+     *
+     * A message of up to 8 bytes is transmitted by the function, and a longer one
+     * is transmitted by BAM for the global destination or by RTS/CTS otherwise.
+     *
+     * @param pgn      A PGN.
+     * @param priority A priority.
+     * @param da       A destination address.
+     * @param data     Message data, which shall be kept till the transfer completes.
+     * @param size     Message size in bytes.
+     * @return True if the transfer is started, or false if no TX mailbox is free now.
+     */
+    bool_t send(uint32_t pgn, uint8_t priority, uint8_t da, uint8_t const* data, size_t size);
+
+    /**
+     * @brief Returns status of the last multi-packet message sent to a destination.
+     *
+     * @param da A destination address.
+     * @return The status.
+     */
+    Status getTxStatus(uint8_t da) const;
+
+    /**
+     * @brief Handles a frame received.
+     *
+     * @param frame A frame received.
+     * @return True if the frame is consumed by the layer.
+     */
+    bool_t handle(Can::Frame const& frame);
+
+    /**
+     * @brief Transmits all the frames which time has come and checks timeouts.
+     *
+     * @return Number of frames transmitted.
+     */
+    int32_t process();
+
+    /**
+     * @brief Returns time to the next process() call.
+     *
+     * @return Time in microseconds, or zero if a frame is due, or TIMEOUT_TR if nothing is pending.
+     */
+    uint32_t getDelay();
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @enum Step
+     * @brief Step of a session.
+     */
+    enum Step
+    {
+        STEP_NONE     = 0, ///< The session is free
+        STEP_WAIT_CTS = 1, ///< Waiting for CTS
+        STEP_SEND_DT  = 2, ///< Sending data packets
+        STEP_WAIT_ACK = 3, ///< Waiting for the end of message acknowledge
+        STEP_RECEIVE  = 4  ///< Receiving data packets
+    };
+
+    /**
+     * @struct TxSession
+     * @brief Session of sending.
+     */
+    struct TxSession
+    {
+        Step           step;     ///< Step of the session
+        Status         status;   ///< Status of the last transfer
+        uint32_t       pgn;      ///< PGN of the message
+        uint8_t        priority; ///< Priority of the message
+        uint8_t        da;       ///< Destination address
+        uint8_t const* data;     ///< Message data
+        size_t         size;     ///< Message size
+        uint8_t        packets;  ///< Number of packets
+        uint8_t        next;     ///< Number of the next packet
+        uint8_t        last;     ///< Number of the last packet allowed to send
+        uint32_t       time;     ///< Time of the next packet or the timeout
+    };
+
+    /**
+     * @struct RxSession
+     * @brief Session of receiving.
+     */
+    struct RxSession
+    {
+        Step     step;                         ///< Step of the session
+        uint32_t pgn;                          ///< PGN of the message
+        uint8_t  priority;                     ///< Priority of the message
+        uint8_t  sa;                           ///< Source address
+        bool_t   isBam;                        ///< The message is broadcast
+        size_t   size;                         ///< Message size
+        uint8_t  packets;                      ///< Number of packets
+        uint8_t  next;                         ///< Number of the next packet
+        uint8_t  last;                         ///< Number of the last packet of the window
+        uint8_t  window;                       ///< Maximum packets in the window requested by the sender
+        uint32_t time;                         ///< Time of the timeout
+        bool_t   isResponsePending;            ///< A CTS or an end of message acknowledge has not been transmitted
+        uint8_t  buffer[MAXIMUM_MESSAGE_SIZE]; ///< Message data
+    };
+
+    /**
+     * @struct Registration
+     * @brief Handler registered for a PGN.
+     */
+    struct Registration
+    {
+        uint32_t pgn;     ///< A PGN
+        Handler* handler; ///< A handler
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Handles a connection management frame.
+     *
+     * @param id   Identifier of the frame.
+     * @param data Frame data.
+     */
+    void handleConnection(Id const& id, uint8_t const* data);
+
+    /**
+     * @brief Handles a data transfer frame.
+     *
+     * @param id   Identifier of the frame.
+     * @param data Frame data.
+     */
+    void handleData(Id const& id, uint8_t const* data);
+
+    /**
+     * @brief Handles an address claimed frame.
+     *
+     * @param id   Identifier of the frame.
+     * @param data Frame data.
+     */
+    void handleAddress(Id const& id, uint8_t const* data);
+
+    /**
+     * @brief Dispatches a message to its handler.
+     *
+     * @param id   Identifier of the message.
+     * @param data Message data.
+     * @param size Message size.
+     */
+    void dispatch(Id const& id, uint8_t const* data, size_t size);
+
+    /**
+     * @brief Sends data packets which time has come.
+     *
+     * @param session The session.
+     * @param time    Current time.
+     * @return Number of frames transmitted.
+     */
+    int32_t sendData(TxSession& session, uint32_t time);
+
+    /**
+     * @brief Transmits a connection management frame.
+     *
+     * @param da      A destination address.
+     * @param control Control byte.
+     * @param a       Byte 1 of the frame.
+     * @param b       Byte 2 of the frame.
+     * @param c       Byte 3 of the frame.
+     * @param d       Byte 4 of the frame.
+     * @param pgn     PGN of the transported message.
+     * @return True if transmitted.
+     */
+    bool_t sendConnection(uint8_t da, uint8_t control, uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint32_t pgn);
+
+    /**
+     * @brief Transmits the address claimed or the cannot claim address frame.
+     *
+     * @return True if transmitted.
+     */
+    bool_t sendAddress();
+
+    /**
+     * @brief Transmits a CTS of an RX session receiving, or the end of message acknowledge.
+     *
+     * @param session The session.
+     * @return True if transmitted.
+     */
+    bool_t sendResponse(RxSession& session);
+
+    /**
+     * @brief Transmits a frame.
+     *
+     * @param pgn      A PGN.
+     * @param priority A priority.
+     * @param da       A destination address.
+     * @param data     Frame data.
+     * @param size     Size of the data, and the rest of 8 bytes is padded.
+     * @return True if transmitted, or false if no TX mailbox is free.
+     */
+    bool_t transmit(uint32_t pgn, uint8_t priority, uint8_t da, uint8_t const* data, size_t size);
+
+    /**
+     * @brief Finds an RX session of a source.
+     *
+     * @param sa    A source address.
+     * @param isBam The session is broadcast.
+     * @return The session, or NULLPTR.
+     */
+    RxSession* findRxSession(uint8_t sa, bool_t isBam);
+
+    /**
+     * @brief Finds a TX session of a destination.
+     *
+     * @param da A destination address.
+     * @return The session, or NULLPTR.
+     */
+    TxSession* findTxSession(uint8_t da);
+
+    /**
+     * @brief Tests if a PGN is of the PDU1 format.
+     *
+     * @param pgn A PGN.
+     * @return True if the PGN is destination specific.
+     */
+    static bool_t isPdu1(uint32_t pgn);
+
+    /**
+     * @brief Tests if a time has come.
+     *
+     * @param time Current time.
+     * @param when A time to test.
+     * @return True if the time has come.
+     */
+    static bool_t isExpired(uint32_t time, uint32_t when);
+
+    static const uint8_t  CM_RTS         = 16;      ///< Request to send
+    static const uint8_t  CM_CTS         = 17;      ///< Clear to send
+    static const uint8_t  CM_ACK         = 19;      ///< End of message acknowledge
+    static const uint8_t  CM_BAM         = 32;      ///< Broadcast announce message
+    static const uint8_t  CM_ABORT       = 255;     ///< Connection abort
+    static const uint8_t  ABORT_BUSY     = 1;       ///< Abort reason of a session in progress
+    static const uint8_t  ABORT_RESOURCE = 2;       ///< Abort reason of no resources
+    static const uint8_t  ABORT_TIMEOUT  = 3;       ///< Abort reason of timeout
+    static const uint8_t  PRIORITY_TP    = 7;       ///< Priority of transport protocol frames
+    static const uint8_t  PRIORITY_NM    = 6;       ///< Priority of network management frames
+    static const uint8_t  PADDING        = 0xFF;    ///< Frame data byte to pad a frame
+    static const uint8_t  ADDRESS_FIRST  = 128;     ///< First self-configurable address
+    static const uint8_t  ADDRESS_LAST   = 247;     ///< Last self-configurable address
+    static const uint8_t  PF_PDU2        = 240;     ///< First PDU format value of PDU2
+    static const size_t   PACKET_SIZE    = 7;       ///< Data size of a packet
+    static const uint32_t TIMEOUT_TR     = 200000;  ///< Response timeout
+    static const uint32_t TIMEOUT_T1     = 750000;  ///< Timeout between data packets received
+    static const uint32_t TIMEOUT_T2     = 1250000; ///< Timeout of data packets after CTS
+    static const uint32_t TIMEOUT_T3     = 1250000; ///< Timeout of CTS or acknowledge after the last packet
+    static const uint32_t TIMEOUT_T4     = 1050000; ///< Timeout of CTS after a hold
+    static const uint32_t TIMEOUT_CLAIM  = 250000;  ///< Contention time of the address claim
+    static const uint32_t TIME_BAM       = 50000;   ///< Time between BAM data packets
+
+    /**
+     * @brief Driver to transmit frames.
+     */
+    Can& can_;
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase& timebase_;
+
+    /**
+     * @brief NAME of the controller application.
+     */
+    uint64_t name_;
+
+    /**
+     * @brief Preferred or claimed address.
+     */
+    uint8_t address_;
+
+    /**
+     * @brief State of the address claim.
+     */
+    Claim claim_;
+
+    /**
+     * @brief Time of the address claim completion.
+     */
+    uint32_t claimTime_;
+
+    /**
+     * @brief Number of addresses tried to claim.
+     */
+    int32_t attempts_;
+
+    /**
+     * @brief The address claimed frame has not been transmitted.
+     */
+    bool_t isAddressPending_;
+
+    /**
+     * @brief Handlers registered.
+     */
+    Registration handlers_[MAXIMUM_NUMBER_OF_PGNS];
+
+    /**
+     * @brief TX sessions.
+     */
+    TxSession txSessions_[MAXIMUM_NUMBER_OF_SESSIONS];
+
+    /**
+     * @brief RX sessions.
+     */
+    RxSession rxSessions_[MAXIMUM_NUMBER_OF_SESSIONS];
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANJ1939_HPP_
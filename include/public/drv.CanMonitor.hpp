@@ -0,0 +1,258 @@
+/**
+ * @file      drv.CanMonitor.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANMONITOR_HPP_
+#define DRV_CANMONITOR_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanTimebase.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanMonitor
+ * @brief Supervisor of cyclic identifiers received.
+ *
+ * The monitor watches identifiers for missing frames. A driver refreshes a watch by
+ * the refresh() function called by the RX FIFO interrupts, which only finds the watch
+ * in a hash table and stores the reception time. The deadlines are kept in a hierarchical
+ * timer wheel of three levels of 64 slots, and process() visits only the slots which
+ * time has come. A watch whose deadline comes is rescheduled to its actual deadline
+ * if a frame has been received, or reported as timed out otherwise, so the cost
+ * of process() is of the expired deadlines and not of the identifiers watched.
+ *
+ * A timed out watch is checked every timeout till a frame is received, and a timeout
+ * is reported once till a frame is received.
+ *
+ * @note The refresh() function is called by the CAN interrupts, which have to be of one priority.
+ *       The other functions are not thread-safe, and a watch is added while the monitor is set.
+ */
+class CanMonitor : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @class Handler
+     * @brief Handler of timeouts.
+     */
+    class Handler
+    {
+
+    public:
+
+        /**
+         * @brief Destructor.
+         */
+        virtual ~Handler() {}
+
+        /**
+         * @brief Handles a timeout of a watch.
+         *
+         * @param watch Index of the watch.
+         */
+        virtual void handle(int32_t watch) = 0;
+
+    };
+
+    /**
+     * @brief Maximum number of watches.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_WATCHES = 192;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param timebase Time source of the monitor.
+     * @param tick     Resolution of the timeouts in microseconds.
+     * @param handler  Handler of timeouts.
+     */
+    CanMonitor(CanTimebase& timebase, uint32_t tick, Handler& handler);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanMonitor();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Watches an identifier.
+     *
+     * The first frame is expected in the timeout after the call.
+     *
+     * @param id         An identifier.
+     * @param isExtended The identifier is of 29 bits.
+     * @param timeout    Maximum time between frames in microseconds.
+     * @return Index of the watch, or -1 if no free watch or the identifier is watched.
+     */
+    int32_t watch(uint32_t id, bool_t isExtended, uint32_t timeout);
+
+    /**
+     * @brief Tests if a watch is timed out.
+     *
+     * @param watch Index of the watch.
+     * @return True if no frame is received in the timeout.
+     */
+    bool_t isTimeout(int32_t watch);
+
+    /**
+     * @brief Refreshes the watch of a frame received.
+     *
+     * @param frame A frame received.
+     * @return True if the frame identifier is watched.
+     */
+    bool_t refresh(Can::Frame const& frame);
+
+    /**
+     * @brief Advances the timer wheel to the current time and reports the timeouts.
+     *
+     * @return Number of timeouts reported.
+     */
+    int32_t process();
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @struct Watch
+     * @brief Watch of an identifier.
+     */
+    struct Watch
+    {
+        uint32_t          key;       ///< Identifier word of the frames
+        uint32_t          timeout;   ///< Timeout in microseconds
+        uint32_t          ticks;     ///< Timeout in ticks
+        uint32_t volatile time;      ///< Time of the last frame received
+        bool_t            isFired;   ///< The timeout is reported
+        uint32_t          deadline;  ///< Tick of the deadline scheduled
+        int32_t           next;      ///< Next watch in a wheel slot
+        int32_t volatile  chain;     ///< Next watch in a hash bucket
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Processes one tick of the wheel.
+     *
+     * @return Number of timeouts reported.
+     */
+    int32_t advance();
+
+    /**
+     * @brief Moves the watches of a slot to lower levels.
+     *
+     * @param slot Head of the slot.
+     */
+    void cascade(int32_t& slot);
+
+    /**
+     * @brief Checks a watch which deadline has come.
+     *
+     * @param index Index of the watch.
+     * @return True if a timeout is reported.
+     */
+    bool_t check(int32_t index);
+
+    /**
+     * @brief Schedules a watch.
+     *
+     * @param index    Index of the watch.
+     * @param deadline Tick of the deadline.
+     */
+    void schedule(int32_t index, uint32_t deadline);
+
+    /**
+     * @brief Returns a hash of an identifier word.
+     *
+     * @param key An identifier word.
+     * @return Index of the hash bucket.
+     */
+    static uint32_t hash(uint32_t key);
+
+    /**
+     * @brief Tests if a time has come.
+     *
+     * @param time Current time.
+     * @param when A time to test.
+     * @return True if the time has come.
+     */
+    static bool_t isExpired(uint32_t time, uint32_t when);
+
+    static const int32_t  NUMBER_OF_LEVELS  = 3;          ///< Levels of the timer wheel
+    static const uint32_t SLOT_BITS         = 6;          ///< Bits of a slot index
+    static const uint32_t NUMBER_OF_SLOTS   = 64;         ///< Slots of one level
+    static const uint32_t SLOT_MASK         = 63;         ///< Mask of a slot index
+    static const uint32_t NUMBER_OF_BUCKETS = 256;        ///< Buckets of the hash table
+    static const uint32_t KEY_MASK          = 0xFFFFFFFC; ///< Identifier and IDE bits of an identifier word
+    static const int32_t  NONE              = -1;         ///< No watch
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase& timebase_;
+
+    /**
+     * @brief Tick in microseconds.
+     */
+    uint32_t tick_;
+
+    /**
+     * @brief Handler of timeouts.
+     */
+    Handler& handler_;
+
+    /**
+     * @brief Number of the watches.
+     */
+    int32_t count_;
+
+    /**
+     * @brief Current tick processed.
+     */
+    uint32_t current_;
+
+    /**
+     * @brief Time of the current tick.
+     */
+    uint32_t currentTime_;
+
+    /**
+     * @brief Watches.
+     */
+    Watch watches_[MAXIMUM_NUMBER_OF_WATCHES];
+
+    /**
+     * @brief Hash table of the watches.
+     */
+    int32_t volatile buckets_[NUMBER_OF_BUCKETS];
+
+    /**
+     * @brief Slots of the timer wheel levels.
+     */
+    int32_t slots_[NUMBER_OF_LEVELS][NUMBER_OF_SLOTS];
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANMONITOR_HPP_
@@ -0,0 +1,305 @@
+/**
+ * @file      drv.CanPdo.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANPDO_HPP_
+#define DRV_CANPDO_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanTimebase.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanPdo
+ * @brief CANopen PDO engine.
+ *
+ * The engine maps PDO frames to object dictionary variables by precomputed tables.
+ * Each entry of a table binds a bit field of the frame data directly to a variable,
+ * so an RPDO is unpacked and a TPDO is built by one loop over the table with no
+ * object dictionary lookup. The variables are little-endian as the frame data, and
+ * a variable has the latest value written by an RPDO or by the application.
+ *
+ * A synchronous RPDO is stored when received, and its latest data is applied to the variables
+ * on the next SYNC. A synchronous TPDO is built and transmitted right on the SYNC which
+ * triggers it, and the time from the SYNC handled to the TPDO transmitted is measured.
+ * An event-driven TPDO is transmitted on trigger() or by its event timer, and not earlier
+ * than its inhibit time after the previous one.
+ *
+ * The engine does not block, and it is not thread-safe. A caller shall pass every frame
+ * received to handle(), and shall call process() periodically, and it may sleep
+ * for getDelay() microseconds between the calls.
+ */
+class CanPdo : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @struct Entry
+     * @brief Mapping of one object to frame data.
+     */
+    struct Entry
+    {
+        uint8_t* object; ///< Variable of the object, which is of (length + 7) / 8 bytes
+        uint8_t  offset; ///< Bit offset in the frame data
+        uint8_t  length; ///< Length in bits from 1 to 64
+    };
+
+    /**
+     * @struct Pdo
+     * @brief PDO communication and mapping parameters.
+     */
+    struct Pdo
+    {
+        uint32_t     cobId;       ///< COB-ID of 11 bits
+        uint8_t      type;        ///< Transmission type
+        uint8_t      size;        ///< Frame data size in bytes
+        uint32_t     inhibitTime; ///< Minimal time between event-driven TPDOs in microseconds, or zero
+        uint32_t     eventTime;   ///< Event timer of an event-driven TPDO in microseconds, or zero
+        Entry const* entries;     ///< Mapping table, which shall be kept while the PDO is set
+        int32_t      count;       ///< Number of the mapping table entries
+    };
+
+    static const uint8_t  TYPE_SYNC_ACYCLIC = 0;   ///< Synchronous on the SYNC after an event
+    static const uint8_t  TYPE_SYNC_LAST    = 240; ///< Synchronous on every 1st to 240th SYNC
+    static const uint8_t  TYPE_EVENT        = 254; ///< Event-driven of manufacturer specific
+    static const uint8_t  TYPE_EVENT_DEVICE = 255; ///< Event-driven of device profile specific
+    static const uint32_t COBID_SYNC        = 0x080; ///< COB-ID of SYNC
+
+    /**
+     * @brief Maximum number of RPDOs and TPDOs each.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_PDOS = 4;
+
+    /**
+     * @brief Time to the next process() call if nothing is pending in microseconds.
+     */
+    static const uint32_t TIMEOUT = 1000000;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param can      A driver to transmit frames.
+     * @param timebase Time source of the engine.
+     */
+    CanPdo(Can& can, CanTimebase& timebase);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanPdo();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Sets an RPDO.
+     *
+     * @param pdo Parameters of the PDO.
+     * @return Index of the RPDO, or -1 if no free RPDO or the mapping is wrong.
+     */
+    int32_t setRpdo(Pdo const& pdo);
+
+    /**
+     * @brief Sets a TPDO.
+     *
+     * @param pdo Parameters of the PDO.
+     * @return Index of the TPDO, or -1 if no free TPDO or the mapping is wrong.
+     */
+    int32_t setTpdo(Pdo const& pdo);
+
+    /**
+     * @brief Triggers an event of a TPDO.
+     *
+     * An event-driven TPDO is transmitted by next process() call after its inhibit time,
+     * and an acyclic synchronous TPDO is transmitted on next SYNC.
+     *
+     * @param tpdo Index of the TPDO.
+     * @return True if triggered.
+     */
+    bool_t trigger(int32_t tpdo);
+
+    /**
+     * @brief Handles a frame received.
+     *
+     * @param frame A frame received.
+     * @return True if the frame is SYNC or an RPDO.
+     */
+    bool_t handle(Can::Frame const& frame);
+
+    /**
+     * @brief Transmits all the TPDOs which time has come.
+     *
+     * @return Number of frames transmitted.
+     */
+    int32_t process();
+
+    /**
+     * @brief Returns time to the next process() call.
+     *
+     * @return Time in microseconds, or zero if a TPDO is due, or TIMEOUT if nothing is pending.
+     */
+    uint32_t getDelay();
+
+    /**
+     * @brief Returns time from the last SYNC handled to the last TPDO transmitted on it.
+     *
+     * @return Time in microseconds.
+     */
+    uint32_t getSyncLatency() const;
+
+    /**
+     * @brief Returns maximum time from a SYNC handled to a TPDO transmitted on it.
+     *
+     * @return Time in microseconds.
+     */
+    uint32_t getMaximumSyncLatency() const;
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @struct Rpdo
+     * @brief RPDO state.
+     */
+    struct Rpdo
+    {
+        bool_t   isSet;     ///< The RPDO is set
+        Pdo      pdo;       ///< Parameters
+        uint32_t ir;        ///< Identifier word of the frames
+        bool_t   isPending; ///< Data is received and waits for SYNC
+        uint64_t data;      ///< Data received
+    };
+
+    /**
+     * @struct Tpdo
+     * @brief TPDO state.
+     */
+    struct Tpdo
+    {
+        bool_t   isSet;     ///< The TPDO is set
+        Pdo      pdo;       ///< Parameters
+        uint32_t ir;        ///< Identifier word of the frames
+        bool_t   isEvent;   ///< An event is triggered
+        bool_t   isPending; ///< Transmission on SYNC has failed and is retried
+        uint32_t syncs;     ///< SYNCs counted since the last transmission
+        uint32_t inhibit;   ///< Time when the inhibit time elapses
+        uint32_t timer;     ///< Time when the event timer elapses
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Handles SYNC.
+     */
+    void sync();
+
+    /**
+     * @brief Builds and transmits a TPDO.
+     *
+     * @param tpdo The TPDO.
+     * @return True if transmitted, or false if no TX mailbox is free.
+     */
+    bool_t transmit(Tpdo& tpdo);
+
+    /**
+     * @brief Tests if a PDO is synchronous.
+     *
+     * @param pdo The PDO.
+     * @return True if the PDO is synchronous.
+     */
+    static bool_t isSync(Pdo const& pdo);
+
+    /**
+     * @brief Tests if a mapping table fits a PDO.
+     *
+     * @param pdo The PDO.
+     * @return True if all the entries are in the frame data.
+     */
+    static bool_t isMapping(Pdo const& pdo);
+
+    /**
+     * @brief Unpacks frame data to the objects.
+     *
+     * @param pdo  The PDO.
+     * @param data Frame data.
+     */
+    static void unpack(Pdo const& pdo, uint64_t data);
+
+    /**
+     * @brief Packs the objects to frame data.
+     *
+     * @param pdo The PDO.
+     * @return Frame data.
+     */
+    static uint64_t pack(Pdo const& pdo);
+
+    /**
+     * @brief Tests if a time has come.
+     *
+     * @param time Current time.
+     * @param when A time to test.
+     * @return True if the time has come.
+     */
+    static bool_t isExpired(uint32_t time, uint32_t when);
+
+    static const uint32_t IR_KEY_MASK = 0xFFFFFFFE; ///< Identifier, IDE and RTR bits of an identifier word
+
+    /**
+     * @brief Driver to transmit frames.
+     */
+    Can& can_;
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase& timebase_;
+
+    /**
+     * @brief RPDOs.
+     */
+    Rpdo rpdos_[MAXIMUM_NUMBER_OF_PDOS];
+
+    /**
+     * @brief TPDOs.
+     */
+    Tpdo tpdos_[MAXIMUM_NUMBER_OF_PDOS];
+
+    /**
+     * @brief Time of the last SYNC.
+     */
+    uint32_t syncTime_;
+
+    /**
+     * @brief Latency of the last TPDO on SYNC.
+     */
+    uint32_t latency_;
+
+    /**
+     * @brief Maximum latency of a TPDO on SYNC.
+     */
+    uint32_t maxLatency_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANPDO_HPP_
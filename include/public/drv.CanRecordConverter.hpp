@@ -0,0 +1,286 @@
+/**
+ * @file      drv.CanRecordConverter.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRECORDCONVERTER_HPP_
+#define DRV_CANRECORDCONVERTER_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanRecorder.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanRecordConverter
+ * @brief Converter of CAN binary log to candump and Vector ASC text.
+ *
+ * The converter decodes a log written by CanRecorder, or parses a candump log
+ * for replaying it. It is built with the driver library, and it touches no
+ * registers and allocates no dynamic memory, so every text line is formatted
+ * to a buffer given by a caller.
+ */
+class CanRecordConverter : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @enum Format
+     * @brief Format of a log to read.
+     */
+    enum Format
+    {
+        FORMAT_BINARY  = 0, ///< Binary log written by CanRecorder
+        FORMAT_CANDUMP = 1  ///< Text log of candump in "(1.000000) can0 123#00" lines
+    };
+
+    /**
+     * @struct Record
+     * @brief Decoded record.
+     */
+    struct Record
+    {
+        uint64_t            time;    ///< Time from the log start in microseconds
+        CanRecorder::Source source;  ///< Message source
+        Can::Message        message; ///< Message
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param log    Log to read, which is a binary log starting with the log header, or candump text.
+     * @param size   Size of the log in bytes.
+     * @param format Format of the log.
+     */
+    CanRecordConverter(uint8_t const* log, size_t size, Format format = FORMAT_BINARY);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanRecordConverter();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Decodes next record of the log.
+     *
+     * @param record A record to decode to.
+     * @return True if a record is decoded, or false if the log ends.
+     */
+    bool_t read(Record* record);
+
+    /**
+     * @brief Rewinds the log to the first record.
+     */
+    void rewind();
+
+    /**
+     * @brief Parses a candump log line.
+     *
+     * The record time is the line time, and the record source is RX FIFO 0.
+     *
+     * @param line   A line which is not obligatory null terminated.
+     * @param size   Size of the line in characters.
+     * @param record A record to parse to.
+     * @return True if the line is parsed.
+     */
+    static bool_t fromCandump(char_t const* line, size_t size, Record* record);
+
+    /**
+     * @brief Formats a record to a candump log line.
+     *
+     * The line is like "(0000000001.000123) can0 123#DEADBEEF" terminated with a new line.
+     *
+     * @param record    A record to format.
+     * @param interface An interface name.
+     * @param str       A buffer for the line.
+     * @param size      Size of the buffer in characters including a terminating null.
+     * @return Number of characters written without the terminating null, or -1 if no space.
+     */
+    static int32_t toCandump(Record const& record, char_t const* interface, char_t* str, int32_t size);
+
+    /**
+     * @brief Formats a record to a Vector ASC log line.
+     *
+     * The line is like "   1.000123 1  123             Rx   d 4 DE AD BE EF" terminated with a new line.
+     *
+     * @param record  A record to format.
+     * @param channel A channel number.
+     * @param str     A buffer for the line.
+     * @param size    Size of the buffer in characters including a terminating null.
+     * @return Number of characters written without the terminating null, or -1 if no space.
+     */
+    static int32_t toAsc(Record const& record, int32_t channel, char_t* str, int32_t size);
+
+    /**
+     * @brief Formats a Vector ASC file header.
+     *
+     * @param str  A buffer for the header.
+     * @param size Size of the buffer in characters including a terminating null.
+     * @return Number of characters written without the terminating null, or -1 if no space.
+     */
+    static int32_t toAscHeader(char_t* str, int32_t size);
+
+    /**
+     * @brief Formats a Vector ASC file footer.
+     *
+     * @param str  A buffer for the footer.
+     * @param size Size of the buffer in characters including a terminating null.
+     * @return Number of characters written without the terminating null, or -1 if no space.
+     */
+    static int32_t toAscFooter(char_t* str, int32_t size);
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @class Text
+     * @brief Text writer to a buffer.
+     */
+    class Text
+    {
+
+    public:
+
+        /**
+         * @brief Constructor.
+         *
+         * @param str  A buffer.
+         * @param size Size of the buffer in characters.
+         */
+        Text(char_t* str, int32_t size);
+
+        /**
+         * @brief Writes a string.
+         *
+         * @param str A null terminated string.
+         */
+        void put(char_t const* str);
+
+        /**
+         * @brief Writes a character.
+         *
+         * @param ch A character.
+         */
+        void put(char_t ch);
+
+        /**
+         * @brief Writes a number in hexadecimal.
+         *
+         * @param value  A number.
+         * @param digits Minimum number of digits.
+         */
+        void putHex(uint32_t value, int32_t digits);
+
+        /**
+         * @brief Writes a number in decimal.
+         *
+         * @param value  A number.
+         * @param digits Minimum number of digits.
+         * @param fill   A character to fill leading positions.
+         */
+        void putDec(uint64_t value, int32_t digits, char_t fill);
+
+        /**
+         * @brief Terminates the text.
+         *
+         * @return Length of the text, or -1 if the buffer is overflowed.
+         */
+        int32_t end();
+
+    private:
+
+        char_t* str_;   ///< Buffer
+        int32_t size_;  ///< Buffer size
+        int32_t len_;   ///< Text length
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Decodes next record of the binary log.
+     *
+     * @param record A record to decode to.
+     * @return True if a record is decoded.
+     */
+    bool_t readBinary(Record* record);
+
+    /**
+     * @brief Parses next line of the candump log.
+     *
+     * @param record A record to parse to.
+     * @return True if a record is parsed.
+     */
+    bool_t readCandump(Record* record);
+
+    /**
+     * @brief Parses a hexadecimal number.
+     *
+     * @param str    A string.
+     * @param size   Size of the string.
+     * @param pos    Position to parse from, which is moved after the number.
+     * @param digits Maximum number of digits to parse.
+     * @param value  The parsed value.
+     * @return Number of parsed digits.
+     */
+    static int32_t parseHex(char_t const* str, size_t size, size_t* pos, int32_t digits, uint32_t* value);
+
+    /**
+     * @brief Parses a decimal number.
+     *
+     * @param str    A string.
+     * @param size   Size of the string.
+     * @param pos    Position to parse from, which is moved after the number.
+     * @param value  The parsed value.
+     * @return Number of parsed digits.
+     */
+    static int32_t parseDec(char_t const* str, size_t size, size_t* pos, uint64_t* value);
+
+    /**
+     * @brief Log.
+     */
+    uint8_t const* log_;
+
+    /**
+     * @brief Size of the log.
+     */
+    size_t size_;
+
+    /**
+     * @brief Log format.
+     */
+    Format format_;
+
+    /**
+     * @brief Read position.
+     */
+    size_t pos_;
+
+    /**
+     * @brief Time of the last decoded record.
+     */
+    uint64_t time_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRECORDCONVERTER_HPP_
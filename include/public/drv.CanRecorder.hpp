@@ -0,0 +1,183 @@
+/**
+ * @file      drv.CanRecorder.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRECORDER_HPP_
+#define DRV_CANRECORDER_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanTimebase.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanRecorder
+ * @brief CAN traffic recorder to compact binary log.
+ *
+ * The recorder encodes every tapped message to a byte ring buffer given by a caller.
+ * The log starts with a header of LOG_HEADER_SIZE bytes, and each record is encoded as:
+ *  - one byte of DLC in bits 0-3, RTR in bit 4, IDE in bit 5, and the message source in bits 6-7;
+ *  - time delta to the previous record in microseconds as unsigned LEB128 of 1 to 5 bytes;
+ *  - two bytes of a base identifier or four bytes of an extended identifier in little-endian;
+ *  - DLC bytes of data if the message is not a remote request.
+ *
+ * @note The record() function is called by the CAN interrupts, which have to be of one priority
+ *       as the recorder has no guard between producers.
+ */
+class CanRecorder : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @enum Source
+     * @brief Source of a recorded message.
+     */
+    enum Source
+    {
+        SOURCE_RXFIFO_0 = 0, ///< Message received to RX FIFO 0
+        SOURCE_RXFIFO_1 = 1, ///< Message received to RX FIFO 1
+        SOURCE_TX       = 2  ///< Message transmitted successfully
+    };
+
+    /**
+     * @brief Size of the log header in bytes.
+     */
+    static const int32_t LOG_HEADER_SIZE = 4;
+
+    /**
+     * @brief Maximum size of one record in bytes.
+     */
+    static const int32_t MAXIMUM_RECORD_SIZE = 18;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param buffer   Memory for the ring buffer of the log.
+     * @param size     Size of the memory in bytes.
+     * @param timebase Time source for recording.
+     */
+    CanRecorder(uint8_t* buffer, size_t size, CanTimebase& timebase);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanRecorder();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Records a frame.
+     *
+     * @param frame  A frame to record.
+     * @param source The frame source.
+     * @return True if the frame is recorded, or false if no space in the buffer.
+     */
+    bool_t record(Can::Frame const& frame, Source source);
+
+    /**
+     * @brief Reads recorded log bytes and removes them from the buffer.
+     *
+     * @param buffer A buffer to read to.
+     * @param size   Size of the buffer in bytes.
+     * @return Number of bytes read.
+     */
+    size_t read(uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Returns number of messages which have not been recorded as no space.
+     *
+     * @return Number of lost messages.
+     */
+    uint32_t getLost() const;
+
+    /**
+     * @brief Encodes a record to a buffer.
+     *
+     * @param frame  A frame to encode.
+     * @param source The frame source.
+     * @param delta  Time delta to previous record in microseconds.
+     * @param buffer A buffer of MAXIMUM_RECORD_SIZE bytes at least.
+     * @return Number of bytes encoded.
+     */
+    static int32_t encode(Can::Frame const& frame, Source source, uint32_t delta, uint8_t* buffer);
+
+    /**
+     * @brief Encodes the log header to a buffer.
+     *
+     * @param buffer A buffer of LOG_HEADER_SIZE bytes at least.
+     */
+    static void encodeHeader(uint8_t* buffer);
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Writes bytes to the ring buffer.
+     *
+     * @param data Bytes to write.
+     * @param size Number of the bytes.
+     * @return True if the bytes are written.
+     */
+    bool_t write(uint8_t const* data, size_t size);
+
+    /**
+     * @brief Ring buffer memory.
+     */
+    uint8_t* buffer_;
+
+    /**
+     * @brief Ring buffer size in bytes.
+     */
+    size_t size_;
+
+    /**
+     * @brief Write position.
+     */
+    size_t volatile head_;
+
+    /**
+     * @brief Read position.
+     */
+    size_t volatile tail_;
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase& timebase_;
+
+    /**
+     * @brief Time of the last record.
+     */
+    uint32_t time_;
+
+    /**
+     * @brief Lost messages counter.
+     */
+    uint32_t lost_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRECORDER_HPP_
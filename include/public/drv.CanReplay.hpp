@@ -0,0 +1,210 @@
+/**
+ * @file      drv.CanReplay.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANREPLAY_HPP_
+#define DRV_CANREPLAY_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+#include "drv.CanTimebase.hpp"
+#include "drv.CanRecordConverter.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanReplay
+ * @brief Replay of recorded CAN traffic to the driver RX path.
+ *
+ * The replay reads a binary or candump log and injects its received messages
+ * to RX FIFOs of the driver as they are received from the bus. Messages recorded
+ * as transmitted are skipped, as the node under test produces them itself.
+ * The replay does not block, and a caller shall call process() periodically,
+ * and it may sleep for getDelay() microseconds between the calls.
+ */
+class CanReplay : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @enum Timing
+     * @brief Timing of the replay.
+     */
+    enum Timing
+    {
+        TIMING_ORIGINAL = 0, ///< Messages are injected at their recorded time
+        TIMING_SCALED   = 1, ///< Messages are injected at their recorded time scaled by speed
+        TIMING_MAXIMUM  = 2  ///< Messages are injected as soon as RX FIFO has space
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param can      A driver to inject messages to.
+     * @param log      A log to replay.
+     * @param timebase Time source of the replay.
+     */
+    CanReplay(Can& can, CanRecordConverter& log, CanTimebase& timebase);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanReplay();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Sets timing of the replay.
+     *
+     * @param timing Timing of the replay.
+     * @param speed  Speed in percentage of the original timing for TIMING_SCALED,
+     *               which is 200 to replay twice faster and 50 to replay twice slower.
+     * @return True if timing is set.
+     */
+    bool_t setTiming(Timing timing, int32_t speed = 100);
+
+    /**
+     * @brief Injects all the messages which time has come.
+     *
+     * @return Number of injected messages.
+     */
+    int32_t process();
+
+    /**
+     * @brief Returns time to the next message.
+     *
+     * @return Time in microseconds, or zero if the next message is late or the log is ended.
+     */
+    uint32_t getDelay();
+
+    /**
+     * @brief Tests if all the log is replayed.
+     *
+     * @return True if the log is ended.
+     */
+    bool_t isEnd() const;
+
+    /**
+     * @brief Returns number of injected messages.
+     *
+     * @return Number of messages.
+     */
+    uint32_t getInjected() const;
+
+    /**
+     * @brief Restarts the replay from the log start.
+     */
+    void restart();
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Reads the next received message to the pending record.
+     *
+     * @return True if a record is pending.
+     */
+    bool_t fetch();
+
+    /**
+     * @brief Updates the time elapsed from the replay start.
+     */
+    void updateTime();
+
+    /**
+     * @brief Returns time of the pending record from the replay start.
+     *
+     * @return Time in microseconds.
+     */
+    uint64_t getPendingTime() const;
+
+    /**
+     * @brief Driver to inject messages to.
+     */
+    Can& can_;
+
+    /**
+     * @brief Log to replay.
+     */
+    CanRecordConverter& log_;
+
+    /**
+     * @brief Time source.
+     */
+    CanTimebase& timebase_;
+
+    /**
+     * @brief Timing of the replay.
+     */
+    Timing timing_;
+
+    /**
+     * @brief Speed in percentage.
+     */
+    int32_t speed_;
+
+    /**
+     * @brief Pending record to inject.
+     */
+    CanRecordConverter::Record record_;
+
+    /**
+     * @brief Pending record flag.
+     */
+    bool_t isPending_;
+
+    /**
+     * @brief End of the log flag.
+     */
+    bool_t isEnd_;
+
+    /**
+     * @brief Replay started flag.
+     */
+    bool_t isStarted_;
+
+    /**
+     * @brief Log time of the first record.
+     */
+    uint64_t origin_;
+
+    /**
+     * @brief Time elapsed from the replay start.
+     */
+    uint64_t elapsed_;
+
+    /**
+     * @brief Time of the last elapsed time update.
+     */
+    uint32_t time_;
+
+    /**
+     * @brief Injected messages counter.
+     */
+    uint32_t injected_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANREPLAY_HPP_
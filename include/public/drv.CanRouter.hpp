@@ -0,0 +1,256 @@
+/**
+ * @file      drv.CanRouter.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANROUTER_HPP_
+#define DRV_CANROUTER_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "drv.Can.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanRouter
+ * @brief Routing table of frames received.
+ *
+ * A driver passes every frame received to the route() function called by the RX FIFO
+ * interrupts. A frame is found in the table by the index of the filter matched in the RX FIFO
+ * of the frame, as the controller numbers the filter match indexes of each RX FIFO separately,
+ * or by its identifier if no route is of the filter, and a route found rewrites the identifier
+ * and the data of a copy of the frame and forwards the copy to a driver by Can::forward()
+ * or to a target. A route may consume the frame, so the frame is not put to the RX FIFO.
+ *
+ * @note The route() function is called by the CAN interrupts, which have to be of one priority.
+ *       A route is published to the interrupts after it is completed, and a target shall not block.
+ */
+class CanRouter : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @class Target
+     * @brief Consumer of frames forwarded.
+     */
+    class Target
+    {
+
+    public:
+
+        /**
+         * @brief Destructor.
+         */
+        virtual ~Target() {}
+
+        /**
+         * @brief Forwards a frame.
+         *
+         * @param frame A frame forwarded.
+         * @return True if the frame is accepted.
+         */
+        virtual bool_t forward(Can::Frame const& frame) = 0;
+
+    };
+
+    /**
+     * @struct Route
+     * @brief Route of frames.
+     */
+    struct Route
+    {
+        Can*     can;        ///< Driver to transmit frames to, or NULLPTR
+        Target*  target;     ///< Consumer to forward frames to, or NULLPTR
+        bool_t   isConsumed; ///< Frames are not put to the RX FIFO
+        bool_t   isRemapped; ///< The identifier is replaced
+        uint32_t id;         ///< Identifier to replace with
+        bool_t   isExtended; ///< The identifier to replace with is of 29 bits
+        uint64_t dataMask;   ///< Data bits which are kept
+        uint64_t dataValue;  ///< Data bits which are set after the mask
+    };
+
+    /**
+     * @brief Maximum number of routes by identifiers.
+     */
+    static const int32_t MAXIMUM_NUMBER_OF_ROUTES = 32;
+
+    /**
+     * @brief Number of filter match indexes of 14 filter banks of 16-bit identifier lists.
+     */
+    static const uint32_t NUMBER_OF_FILTER_INDEXES = 56;
+
+    /**
+     * @brief Constructor.
+     */
+    CanRouter();
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanRouter();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Sets a route of an identifier.
+     *
+     * @param id         An identifier.
+     * @param isExtended The identifier is of 29 bits.
+     * @param route      The route.
+     * @return True if the route is set.
+     */
+    bool_t setRoute(uint32_t id, bool_t isExtended, Route const& route);
+
+    /**
+     * @brief Sets a route of a filter match index.
+     *
+     * @param fifo  RX FIFO of the filter match index.
+     * @param index A filter match index.
+     * @param route The route.
+     * @return True if the route is set.
+     */
+    bool_t setRoute(Can::RxFifo fifo, uint32_t index, Route const& route);
+
+    /**
+     * @brief Routes a frame received.
+     *
+     * @param frame A frame received.
+     * @param fifo  RX FIFO of the frame.
+     * @return True if the frame is consumed.
+     */
+    bool_t route(Can::Frame const& frame, Can::RxFifo fifo);
+
+    /**
+     * @brief Returns number of frames forwarded.
+     *
+     * @return Number of frames.
+     */
+    uint32_t getForwarded() const;
+
+    /**
+     * @brief Returns number of frames not accepted by a driver or a target.
+     *
+     * @return Number of frames.
+     */
+    uint32_t getDropped() const;
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @struct Entry
+     * @brief Route prepared to apply.
+     */
+    struct Entry
+    {
+        Can*     volatile can;    ///< Driver to transmit frames to
+        Target*  volatile target; ///< Consumer to forward frames to
+        bool_t   isConsumed; ///< Frames are not put to the RX FIFO
+        uint32_t irMask;     ///< Identifier word bits which are kept
+        uint32_t irValue;    ///< Identifier word bits which are set after the mask
+        uint64_t dataMask;   ///< Data bits which are kept
+        uint64_t dataValue;  ///< Data bits which are set after the mask
+        uint32_t key;        ///< Identifier word of a route by identifier
+        int32_t  chain;      ///< Next route in a hash bucket
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct();
+
+    /**
+     * @brief Tests if a route is correct.
+     *
+     * @param route The route.
+     * @return True if the route is correct.
+     */
+    static bool_t isCorrect(Route const& route);
+
+    /**
+     * @brief Prepares a route to apply but the driver and the target, which publish the entry.
+     *
+     * @param route The route.
+     * @param entry An entry to prepare.
+     */
+    static void prepare(Route const& route, Entry* entry);
+
+    /**
+     * @brief Applies a route to a frame.
+     *
+     * @param entry The route.
+     * @param frame A frame received.
+     */
+    void apply(Entry const& entry, Can::Frame const& frame);
+
+    /**
+     * @brief Returns an identifier word.
+     *
+     * @param id         An identifier.
+     * @param isExtended The identifier is of 29 bits.
+     * @return The identifier word.
+     */
+    static uint32_t toIr(uint32_t id, bool_t isExtended);
+
+    /**
+     * @brief Returns a hash of an identifier word.
+     *
+     * @param key An identifier word.
+     * @return Index of the hash bucket.
+     */
+    static uint32_t hash(uint32_t key);
+
+    static const uint32_t NUMBER_OF_BUCKETS = 64;         ///< Buckets of the hash table
+    static const uint32_t KEY_MASK          = 0xFFFFFFFC; ///< Identifier and IDE bits of an identifier word
+    static const int32_t  NONE              = -1;         ///< No route
+    static const int32_t  NUMBER_OF_FIFOS   = 2;          ///< Number of RX FIFOs
+
+    /**
+     * @brief Routes by identifiers.
+     */
+    Entry routes_[MAXIMUM_NUMBER_OF_ROUTES];
+
+    /**
+     * @brief Number of routes by identifiers.
+     */
+    int32_t count_;
+
+    /**
+     * @brief Hash table of routes by identifiers.
+     */
+    int32_t buckets_[NUMBER_OF_BUCKETS];
+
+    /**
+     * @brief Routes by filter match indexes of each RX FIFO.
+     */
+    Entry filters_[NUMBER_OF_FIFOS][NUMBER_OF_FILTER_INDEXES];
+
+    /**
+     * @brief Number of frames forwarded.
+     */
+    uint32_t volatile forwarded_;
+
+    /**
+     * @brief Number of frames dropped.
+     */
+    uint32_t volatile dropped_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANROUTER_HPP_
@@ -0,0 +1,211 @@
+/**
+ * @file      drv.CanRxPriority.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANRXPRIORITY_HPP_
+#define DRV_CANRXPRIORITY_HPP_
+
+#include "lib.NonCopyable.hpp"
+#include "lib.NoAllocator.hpp"
+#include "lib.Thread.hpp"
+#include "api.Task.hpp"
+#include "drv.Can.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanRxPriority
+ * @brief Priority classes of frames received.
+ *
+ * The critical class is received by RX FIFO 0 and the bulk class by RX FIFO 1, and the receive
+ * filters of the classes are programmed in the identifier list mode from the first filter bank given.
+ * Each class has its own consumer thread of its priority, which waits for its RX FIFO only
+ * and passes frames to the handler of the class. As the RX FIFOs have their own interrupts,
+ * SW FIFOs and semaphores, bulk bursts never delay critical frames in a shared queue.
+ *
+ * @note A class without a handler has no consumer thread, and its frames are received
+ *       by the receive functions.
+ */
+class CanRxPriority : public lib::NonCopyable<lib::NoAllocator>
+{
+    typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+public:
+
+    /**
+     * @struct Class
+     * @brief Priority class of frames.
+     */
+    struct Class
+    {
+        uint32_t const* ids;        ///< Identifiers of the class
+        int32_t         number;     ///< Number of the identifiers
+        bool_t          isExtended; ///< The identifiers are of 29 bits
+        int32_t         priority;   ///< Priority of the consumer thread
+        Can::Handler*   handler;    ///< Handler called by the consumer thread, or NULLPTR
+    };
+
+    /**
+     * @struct Config
+     * @brief Priority classes.
+     */
+    struct Config
+    {
+        Class    critical; ///< Critical class received by RX FIFO 0
+        Class    bulk;     ///< Bulk class received by RX FIFO 1
+        uint32_t index;    ///< Index of the first filter bank to use
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param can    A driver.
+     * @param config Priority classes.
+     */
+    CanRxPriority(Can& can, Config const& config);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanRxPriority();
+
+    /**
+     * @copydoc eoos::api::Object::isConstructed()
+     */
+    virtual bool_t isConstructed() const;
+
+    /**
+     * @brief Returns number of filter banks used.
+     *
+     * @return Number of filter banks from the first filter bank given.
+     */
+    uint32_t getNumberOfFilters() const;
+
+protected:
+
+    using Parent::setConstructed;
+
+private:
+
+    /**
+     * @class Consumer
+     * @brief Consumer thread of one RX FIFO.
+     */
+    class Consumer : public lib::NonCopyable<lib::NoAllocator>, public api::Task
+    {
+        typedef lib::NonCopyable<lib::NoAllocator> Parent;
+
+    public:
+
+        /**
+         * @brief Constructor.
+         *
+         * @param can     A driver.
+         * @param fifo    RX FIFO.
+         * @param handler A handler, or NULLPTR.
+         */
+        Consumer(Can& can, Can::RxFifo fifo, Can::Handler* handler);
+
+        /**
+         * @brief Destructor.
+         */
+        virtual ~Consumer();
+
+        /**
+         * @copydoc eoos::api::Object::isConstructed()
+         */
+        virtual bool_t isConstructed() const;
+
+        /**
+         * @copydoc eoos::api::Task::start()
+         */
+        virtual void start();
+
+        /**
+         * @copydoc eoos::api::Task::getStackSize()
+         */
+        virtual size_t getStackSize() const;
+
+        /**
+         * @brief Executes the thread if the consumer has a handler.
+         *
+         * @param priority Priority of the thread.
+         * @return True if executed, or the consumer has no handler.
+         */
+        bool_t execute(int32_t priority);
+
+    protected:
+
+        using Parent::setConstructed;
+
+    private:
+
+        /**
+         * @brief Stack size of the thread, which zero is the system default.
+         */
+        static const size_t STACK_SIZE = 0;
+
+        Can&                          can_;       ///< Driver
+        Can::RxFifo                   fifo_;      ///< RX FIFO
+        Can::Handler*                 handler_;   ///< Handler
+        bool_t volatile               isStopped_; ///< The thread is requested to stop
+        bool_t                        isStarted_; ///< The thread has been executed
+        lib::Thread<lib::NoAllocator> thread_;    ///< Consumer thread
+
+    };
+
+    /**
+     * @brief Constructs this object.
+     *
+     * @param config Priority classes.
+     * @return true if object has been constructed successfully.
+     */
+    bool_t construct(Config const& config);
+
+    /**
+     * @brief Sets the receive filters of a class.
+     *
+     * @param cls  A class.
+     * @param fifo RX FIFO of the class.
+     * @return True if the filters are set.
+     */
+    bool_t setReceiveFilters(Class const& cls, Can::RxFilter::Fifo fifo);
+
+    static const int32_t NUMBER_OF_STANDARD_IDS_IN_FILTER = 4; ///< Identifiers of 11 bits in a 16-bit list filter bank
+    static const int32_t NUMBER_OF_EXTENDED_IDS_IN_FILTER = 2; ///< Identifiers of 29 bits in a 32-bit list filter bank
+    static const uint32_t FILTER16_STID_POS               = 5; ///< Base identifier position of a 16-bit filter
+
+    /**
+     * @brief Driver.
+     */
+    Can& can_;
+
+    /**
+     * @brief Index of the first filter bank.
+     */
+    uint32_t index_;
+
+    /**
+     * @brief Number of filter banks used.
+     */
+    uint32_t filters_;
+
+    /**
+     * @brief Consumer of the critical class.
+     */
+    Consumer critical_;
+
+    /**
+     * @brief Consumer of the bulk class.
+     */
+    Consumer bulk_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANRXPRIORITY_HPP_
@@ -0,0 +1,233 @@
+/**
+ * @file      drv.CanSignal.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANSIGNAL_HPP_
+#define DRV_CANSIGNAL_HPP_
+
+#include "drv.Can.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @struct CanSignalOrder
+ * @brief Byte order of a signal.
+ */
+struct CanSignalOrder
+{
+    /**
+     * @enum Value
+     * @brief Byte order values as of DBC files.
+     */
+    enum Value
+    {
+        MOTOROLA = 0, ///< Big-endian with the start bit of the most significant bit
+        INTEL    = 1  ///< Little-endian with the start bit of the least significant bit
+    };
+};
+
+/**
+ * @struct CanSignalCheck
+ * @brief Compile-time check of a signal definition, which is incomplete for a wrong definition.
+ */
+template <bool_t IS_VALID>
+struct CanSignalCheck;
+
+/**
+ * @struct CanSignalCheck
+ * @brief Compile-time check of a right signal definition.
+ */
+template <>
+struct CanSignalCheck<true>
+{
+};
+
+/**
+ * @class CanSignal
+ * @brief Signal of a message data defined at compile time.
+ *
+ * A signal is defined as in DBC files, where the start bit is counted from bit 0 of byte 0
+ * to bit 7 of byte 7, and the physical value is raw * FACTOR / DIVISOR + OFFSET.
+ * As all the parameters are constants, a signal is extracted and inserted with one shift and
+ * one mask of the 64-bit data word, and a Motorola one takes one more byte reverse.
+ * A wrong definition is a compile error.
+ *
+ * The functions take a Can::Message or a Can::Frame, and expect a little-endian CPU.
+ *
+ * @tparam START     Start bit.
+ * @tparam LENGTH    Length in bits from 1 to 64.
+ * @tparam ORDER     Byte order.
+ * @tparam IS_SIGNED The raw value is two's complement.
+ * @tparam FACTOR    Numerator of the physical scale.
+ * @tparam DIVISOR   Denominator of the physical scale.
+ * @tparam OFFSET    Physical offset.
+ */
+template <uint32_t START, uint32_t LENGTH, CanSignalOrder::Value ORDER = CanSignalOrder::INTEL, bool_t IS_SIGNED = false, int32_t FACTOR = 1, int32_t DIVISOR = 1, int32_t OFFSET = 0>
+class CanSignal
+{
+
+public:
+
+    /**
+     * @brief Extracts the raw bits of the signal.
+     *
+     * @param data The data word of a message.
+     * @return The raw bits.
+     */
+    static uint64_t decode(uint64_t data)
+    {
+        static_cast<void>( sizeof(Check) );
+        if( ORDER == CanSignalOrder::MOTOROLA )
+        {
+            data = swap(data);
+        }
+        return (data >> SHIFT) & MASK;
+    }
+
+    /**
+     * @brief Inserts the raw bits of the signal.
+     *
+     * @param data The data word of a message.
+     * @param raw  The raw bits.
+     * @return The data word with the signal inserted.
+     */
+    static uint64_t encode(uint64_t data, uint64_t raw)
+    {
+        static_cast<void>( sizeof(Check) );
+        if( ORDER == CanSignalOrder::MOTOROLA )
+        {
+            data = swap(data);
+        }
+        data = ( data & ~(MASK << SHIFT) ) | ( (raw & MASK) << SHIFT );
+        if( ORDER == CanSignalOrder::MOTOROLA )
+        {
+            data = swap(data);
+        }
+        return data;
+    }
+
+    /**
+     * @brief Returns the raw value of the signal.
+     *
+     * @param message A message or a frame.
+     * @return The raw value, which is sign-extended for a signed signal.
+     */
+    template <class T>
+    static int64_t get(T const& message)
+    {
+        uint64_t const raw( decode(message.data.v64[0]) );
+        int64_t value( static_cast<int64_t>(raw) );
+        if( IS_SIGNED )
+        {
+            value = static_cast<int64_t>(raw ^ SIGN) - static_cast<int64_t>(SIGN);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Sets the raw value of the signal.
+     *
+     * @param message A message or a frame.
+     * @param value   The raw value.
+     */
+    template <class T>
+    static void set(T* message, int64_t value)
+    {
+        message->data.v64[0] = encode(message->data.v64[0], static_cast<uint64_t>(value));
+    }
+
+    /**
+     * @brief Returns the physical value of the signal.
+     *
+     * @param message A message or a frame.
+     * @return The physical value.
+     */
+    template <class T>
+    static int64_t getPhysical(T const& message)
+    {
+        int64_t value( get(message) );
+        if( FACTOR != 1 )
+        {
+            value *= FACTOR;
+        }
+        if( DIVISOR != 1 )
+        {
+            value /= DIVISOR;
+        }
+        return value + OFFSET;
+    }
+
+    /**
+     * @brief Sets the physical value of the signal.
+     *
+     * @param message A message or a frame.
+     * @param value   The physical value.
+     */
+    template <class T>
+    static void setPhysical(T* message, int64_t value)
+    {
+        value -= OFFSET;
+        if( DIVISOR != 1 )
+        {
+            value *= DIVISOR;
+        }
+        if( FACTOR != 1 )
+        {
+            value /= FACTOR;
+        }
+        set(message, value);
+    }
+
+private:
+
+    /**
+     * @brief Reverses bytes of a data word.
+     *
+     * @param data The data word.
+     * @return The data word reversed.
+     */
+    static uint64_t swap(uint64_t data)
+    {
+        return __builtin_bswap64(data);
+    }
+
+    /**
+     * @brief Bit position of the most significant bit of a Motorola signal in the reversed data word.
+     */
+    static const uint32_t MSB = ( (7 - (START >> 3)) << 3 ) + (START & 7);
+
+    /**
+     * @brief The definition fits the data word.
+     */
+    static const bool_t IS_VALID = LENGTH != 0 && LENGTH <= 64 && START < 64 && DIVISOR != 0 && FACTOR != 0
+        && ( (ORDER == CanSignalOrder::INTEL) ? (START + LENGTH <= 64) : (MSB + 1 >= LENGTH) );
+
+    /**
+     * @brief Bit position of the least significant bit in the data word.
+     */
+    static const uint32_t SHIFT = IS_VALID ? ( (ORDER == CanSignalOrder::INTEL) ? START : (MSB + 1 - LENGTH) ) : 0;
+
+    /**
+     * @brief Mask of the raw bits.
+     */
+    static const uint64_t MASK = IS_VALID ? ( ~static_cast<uint64_t>(0) >> (64 - LENGTH) ) : 0;
+
+    /**
+     * @brief Sign bit of the raw bits.
+     */
+    static const uint64_t SIGN = IS_VALID ? ( static_cast<uint64_t>(1) << (LENGTH - 1) ) : 0;
+
+    /**
+     * @brief Compile-time check of the definition.
+     */
+    typedef CanSignalCheck<IS_VALID> Check;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANSIGNAL_HPP_
@@ -0,0 +1,125 @@
+/**
+ * @file      drv.CanStatic.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANSTATIC_HPP_
+#define DRV_CANSTATIC_HPP_
+
+#include "drv.Can.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+class CanResourceTx;
+class CanResourceRx;
+class CanResourceStatus;
+template <class A> class CanResource;
+
+/**
+ * @class CanStatic
+ * @brief Static CAN driver interface for hot paths.
+ *
+ * The interface calls the TX mailboxes and RX FIFOs of a driver resource directly
+ * without virtual calls of the Can interface. The driver resource created by Can::create()
+ * for the controller is attached to the interface while the resource is alive,
+ * and the Can interface stays an adapter to the same objects.
+ *
+ * The interrupt handlers of the interface are bound to the CAN vectors directly
+ * if EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS equals one, so the interrupts bypass the generic
+ * dispatch of the CPU interrupt controller and the virtual calls of the interrupt routines.
+ *
+ * @tparam N CAN controller number.
+ */
+template <Can::Number N>
+class CanStatic
+{
+    template <class A> friend class CanResource;
+
+public:
+
+    /**
+     * @brief Tests if a driver resource is attached to the controller.
+     *
+     * @return True if the functions can be called.
+     */
+    static bool_t isAttached();
+
+    /**
+     * @copydoc eoos::drv::Can::transmit(Message const&)
+     */
+    static bool_t transmit(Can::Message const& message);
+
+    /**
+     * @copydoc eoos::drv::Can::transmit(Frame const&)
+     */
+    static bool_t transmit(Can::Frame const& frame);
+
+    /**
+     * @copydoc eoos::drv::Can::receive(Message*,RxFifo)
+     */
+    static bool_t receive(Can::Message* message, Can::RxFifo fifo);
+
+    /**
+     * @copydoc eoos::drv::Can::receive(Frame*,RxFifo)
+     */
+    static bool_t receive(Can::Frame* frame, Can::RxFifo fifo);
+
+    /**
+     * @brief Handles the TX interrupt.
+     */
+    static void handleTxInterrupt();
+
+    /**
+     * @brief Handles an RX FIFO interrupt.
+     *
+     * @param fifo RX FIFO.
+     */
+    static void handleRxInterrupt(Can::RxFifo fifo);
+
+    /**
+     * @brief Handles the status change interrupt.
+     */
+    static void handleStatusInterrupt();
+
+private:
+
+    /**
+     * @brief Attaches a driver resource.
+     *
+     * @param tx  TX resource.
+     * @param rx  RX resource.
+     * @param sce Status change resource, or NULLPTR if it is not built.
+     * @return True if attached, or false if other resource is attached.
+     */
+    static bool_t attach(CanResourceTx* tx, CanResourceRx* rx, CanResourceStatus* sce);
+
+    /**
+     * @brief Detaches a driver resource.
+     *
+     * @param tx TX resource attached.
+     */
+    static void detach(CanResourceTx* tx);
+
+    /**
+     * @brief TX resource of the controller.
+     */
+    static CanResourceTx* tx_;
+
+    /**
+     * @brief RX resource of the controller.
+     */
+    static CanResourceRx* rx_;
+
+    /**
+     * @brief Status change resource of the controller.
+     */
+    static CanResourceStatus* sce_;
+
+};
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANSTATIC_HPP_
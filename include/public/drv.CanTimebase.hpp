@@ -0,0 +1,45 @@
+/**
+ * @file      drv.CanTimebase.hpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#ifndef DRV_CANTIMEBASE_HPP_
+#define DRV_CANTIMEBASE_HPP_
+
+#include "api.Object.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class CanTimebase
+ * @brief Time source for the CAN driver.
+ */
+class CanTimebase : public api::Object
+{
+public:
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~CanTimebase() = 0;
+
+    /**
+     * @brief Returns current time.
+     *
+     * The time is a free running counter of microseconds which wraps around on overflow.
+     * The function shall be callable from an interrupt service routine.
+     *
+     * @return Time in microseconds.
+     */
+    virtual uint32_t getTime() = 0;
+
+};
+
+inline CanTimebase::~CanTimebase(){}
+
+} // namespace drv
+} // namespace eoos
+#endif // DRV_CANTIMEBASE_HPP_
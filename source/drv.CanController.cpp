@@ -43,9 +43,11 @@ bool_t CanController::isConstructed() const
 Can* CanController::createResource(Can::Config const& config)
 {
     Resource* ptr( NULLPTR );
-    if( isConstructed() )
+    CanDescriptor const* const descriptor( CanDescriptor::get(config.number) );
+    // Do not construct the interrupt resources of a controller owned by another resource
+    if( isConstructed() && descriptor != NULLPTR && !isAttached(descriptor->number) )
     {
-        lib::UniquePointer<Resource> res( new Resource(data_, config) );
+        lib::UniquePointer<Resource> res( new Resource(data_, *descriptor, config) );
         if( !res.isNull() )
         {
             if( !res->isConstructed() )
@@ -58,6 +60,30 @@ Can* CanController::createResource(Can::Config const& config)
     return ptr;
 }
 
+bool_t CanController::isAttached(Can::Number number)
+{
+    bool_t res( true );
+    switch( number )
+    {
+        case Can::NUMBER_CAN1:
+        {
+            res = CanStatic<Can::NUMBER_CAN1>::isAttached();
+            break;
+        }
+        case Can::NUMBER_CAN2:
+        {
+            res = CanStatic<Can::NUMBER_CAN2>::isAttached();
+            break;
+        }
+        default:
+        {
+            res = true;
+            break;
+        }
+    }
+    return res;
+}
+
 bool_t CanController::construct()
 {
     bool_t res( false );
@@ -0,0 +1,52 @@
+/**
+ * @file      drv.CanDescriptor.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanDescriptor.hpp"
+#include "lib.NoAllocator.hpp"
+#include "cpu.Interrupt.hpp"
+#include "cpu.Registers.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @brief Descriptors of the controllers of the target.
+ */
+static CanDescriptor const descriptors_[] = {
+    {
+        Can::NUMBER_CAN1,                                            // CAN1
+        0,                                                           // Registers of CAN1
+        cpu::Interrupt<lib::NoAllocator>::EXCEPTION_USB_HP_CAN1_TX,  // Transmit interrupt
+        cpu::Interrupt<lib::NoAllocator>::EXCEPTION_USB_LP_CAN1_RX0, // FIFO 0 interrupt
+        cpu::Interrupt<lib::NoAllocator>::EXCEPTION_CAN1_RX1,        // FIFO 1 interrupt
+        cpu::Interrupt<lib::NoAllocator>::EXCEPTION_CAN1_SCE,        // Status change error interrupt
+        0x02000000,                                                  // RCC_APB1ENR.CAN1EN
+        0x00004000,                                                  // DBGMCU_CR.DBG_CAN1_STOP
+        cpu::Registers::INDEX_GPIOA,                                 // IO port A
+        0x00000004,                                                  // RCC_APB2ENR.IOPAEN
+        11,                                                          // CAN1_RX port PA11
+        12                                                           // CAN1_TX port PA12
+    }
+};
+
+CanDescriptor const* CanDescriptor::get(Can::Number number)
+{
+    CanDescriptor const* descriptor( NULLPTR );
+    int32_t const size( static_cast<int32_t>( sizeof(descriptors_) / sizeof(descriptors_[0]) ) );
+    for(int32_t i(0); i<size; i++)
+    {
+        if( descriptors_[i].number == number )
+        {
+            descriptor = &descriptors_[i];
+            break;
+        }
+    }
+    return descriptor;
+}
+
+} // namespace drv
+} // namespace eoos
@@ -0,0 +1,520 @@
+/**
+ * @file      drv.CanIsoTp.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanIsoTp.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanIsoTp::CanIsoTp(Can& can, CanTimebase& timebase)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , can_( can )
+    , timebase_( timebase ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanIsoTp::~CanIsoTp()
+{
+}
+
+bool_t CanIsoTp::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+int32_t CanIsoTp::open(Address const& address, uint8_t* buffer, size_t size, uint8_t blockSize, uint8_t stMin)
+{
+    int32_t index( -1 );
+    if( isConstructed() && buffer != NULLPTR && size != 0 )
+    {
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_CHANNELS; i++)
+        {
+            if( !channels_[i].isOpen )
+            {
+                index = i;
+                break;
+            }
+        }
+    }
+    if( index != -1 )
+    {
+        Channel& ch( channels_[index] );
+        ch.txIr = toIr(address.txId, address.isExtended);
+        ch.rxIr = toIr(address.rxId, address.isExtended);
+        ch.blockSize = blockSize;
+        ch.stMin = stMin;
+        ch.txStatus = STATUS_IDLE;
+        ch.txStep = STEP_NONE;
+        ch.rxStatus = STATUS_IDLE;
+        ch.rxBuffer = buffer;
+        ch.rxCapacity = size;
+        ch.rxSize = 0;
+        ch.isFcPending = false;
+        ch.isOpen = true;
+    }
+    return index;
+}
+
+void CanIsoTp::close(int32_t channel)
+{
+    if( isOpen(channel) )
+    {
+        channels_[channel].isOpen = false;
+    }
+}
+
+bool_t CanIsoTp::send(int32_t channel, uint8_t const* data, size_t size)
+{
+    bool_t res( false );
+    do
+    {
+        if( !isOpen(channel) )
+        {
+            break;
+        }
+        Channel& ch( channels_[channel] );
+        if( data == NULLPTR || size == 0 || size > MAXIMUM_MESSAGE_SIZE )
+        {
+            break;
+        }
+        if( ch.txStep != STEP_NONE )
+        {
+            break;
+        }
+        if( size <= SF_DATA_SIZE )
+        {
+            uint8_t const pci( PCI_TYPE_SF | static_cast<uint8_t>(size) );
+            if( !transmit(ch, &pci, 1, data, size) )
+            {
+                break;
+            }
+            ch.txStatus = STATUS_DONE;
+        }
+        else
+        {
+            uint8_t const pci[2] = {
+                static_cast<uint8_t>( PCI_TYPE_FF | (size >> 8) ),
+                static_cast<uint8_t>( size )
+            };
+            if( !transmit(ch, pci, 2, data, FF_DATA_SIZE) )
+            {
+                break;
+            }
+            ch.txData = data;
+            ch.txSize = size;
+            ch.txOffset = FF_DATA_SIZE;
+            ch.txSn = 1;
+            ch.txStep = STEP_WAIT_FC;
+            ch.txTime = timebase_.getTime() + TIMEOUT;
+            ch.txStatus = STATUS_BUSY;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanIsoTp::handle(Can::Frame const& frame)
+{
+    bool_t res( false );
+    if( isConstructed() && (frame.ir & Can::Frame::IR_RTR_MASK) == 0 )
+    {
+        uint32_t const key( frame.ir & IR_KEY_MASK );
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_CHANNELS; i++)
+        {
+            Channel& ch( channels_[i] );
+            if( ch.isOpen && ch.rxIr == key )
+            {
+                handle(ch, frame);
+                res = true;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+int32_t CanIsoTp::process()
+{
+    int32_t count( 0 );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_CHANNELS; i++)
+        {
+            Channel& ch( channels_[i] );
+            if( !ch.isOpen )
+            {
+                continue;
+            }
+            if( ch.isFcPending && sendFlowControl(ch, ch.fcFlag) )
+            {
+                count++;
+            }
+            if( ch.txStep == STEP_WAIT_FC && isExpired(time, ch.txTime) )
+            {
+                ch.txStep = STEP_NONE;
+                ch.txStatus = STATUS_TIMEOUT;
+            }
+            count += sendConsecutive(ch, time);
+            if( ch.rxStatus == STATUS_BUSY && isExpired(time, ch.rxTime) )
+            {
+                ch.rxStatus = STATUS_TIMEOUT;
+            }
+        }
+    }
+    return count;
+}
+
+uint32_t CanIsoTp::getDelay()
+{
+    uint32_t delay( TIMEOUT );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_CHANNELS; i++)
+        {
+            Channel const& ch( channels_[i] );
+            if( !ch.isOpen )
+            {
+                continue;
+            }
+            if( ch.isFcPending )
+            {
+                delay = 0;
+                break;
+            }
+            if( ch.txStep != STEP_NONE )
+            {
+                uint32_t const diff( isExpired(time, ch.txTime) ? 0 : (ch.txTime - time) );
+                delay = (diff < delay) ? diff : delay;
+            }
+            if( ch.rxStatus == STATUS_BUSY )
+            {
+                uint32_t const diff( isExpired(time, ch.rxTime) ? 0 : (ch.rxTime - time) );
+                delay = (diff < delay) ? diff : delay;
+            }
+        }
+    }
+    return delay;
+}
+
+CanIsoTp::Status CanIsoTp::getTxStatus(int32_t channel) const
+{
+    return isOpen(channel) ? channels_[channel].txStatus : STATUS_IDLE;
+}
+
+CanIsoTp::Status CanIsoTp::getRxStatus(int32_t channel) const
+{
+    return isOpen(channel) ? channels_[channel].rxStatus : STATUS_IDLE;
+}
+
+size_t CanIsoTp::getRxSize(int32_t channel) const
+{
+    size_t size( 0 );
+    if( isOpen(channel) && channels_[channel].rxStatus == STATUS_DONE )
+    {
+        size = channels_[channel].rxSize;
+    }
+    return size;
+}
+
+void CanIsoTp::release(int32_t channel)
+{
+    if( isOpen(channel) && channels_[channel].rxStatus != STATUS_BUSY )
+    {
+        channels_[channel].rxStatus = STATUS_IDLE;
+        channels_[channel].rxSize = 0;
+    }
+}
+
+bool_t CanIsoTp::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !can_.isConstructed() )
+        {
+            break;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_CHANNELS; i++)
+        {
+            channels_[i].isOpen = false;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanIsoTp::isOpen(int32_t channel) const
+{
+    bool_t res( false );
+    if( isConstructed() && channel >= 0 && channel < MAXIMUM_NUMBER_OF_CHANNELS )
+    {
+        res = channels_[channel].isOpen;
+    }
+    return res;
+}
+
+void CanIsoTp::handle(Channel& ch, Can::Frame const& frame)
+{
+    size_t const dlc( frame.dtr & Can::Frame::DTR_DLC_MASK );
+    uint8_t const* const data( frame.data.v8 );
+    uint32_t const time( timebase_.getTime() );
+    // An empty frame has no protocol control information and falls to the default case
+    uint8_t const type( (dlc != 0) ? (data[0] & PCI_TYPE_MASK) : PCI_TYPE_MASK );
+    switch( type )
+    {
+        case PCI_TYPE_SF:
+        {
+            size_t const size( data[0] & PCI_VALUE_MASK );
+            // A message not released yet is kept, and the new one is lost
+            if( size == 0 || size >= dlc || ch.rxStatus == STATUS_DONE )
+            {
+                break;
+            }
+            if( size > ch.rxCapacity )
+            {
+                ch.rxStatus = STATUS_OVERFLOW;
+                break;
+            }
+            for(size_t i(0); i<size; i++)
+            {
+                ch.rxBuffer[i] = data[1 + i];
+            }
+            ch.rxSize = size;
+            ch.rxStatus = STATUS_DONE;
+            break;
+        }
+        case PCI_TYPE_FF:
+        {
+            size_t const size( (static_cast<size_t>(data[0] & PCI_VALUE_MASK) << 8) | data[1] );
+            if( dlc < 8 || size <= SF_DATA_SIZE || ch.rxStatus == STATUS_DONE )
+            {
+                break;
+            }
+            if( size > ch.rxCapacity )
+            {
+                ch.rxStatus = STATUS_OVERFLOW;
+                static_cast<void>( sendFlowControl(ch, FC_OVERFLOW) );
+                break;
+            }
+            for(size_t i(0); i<FF_DATA_SIZE; i++)
+            {
+                ch.rxBuffer[i] = data[2 + i];
+            }
+            ch.rxSize = size;
+            ch.rxOffset = FF_DATA_SIZE;
+            ch.rxSn = 1;
+            ch.rxBlockCount = 0;
+            ch.rxTime = time + TIMEOUT;
+            ch.rxStatus = STATUS_BUSY;
+            static_cast<void>( sendFlowControl(ch, FC_CTS) );
+            break;
+        }
+        case PCI_TYPE_CF:
+        {
+            if( ch.rxStatus != STATUS_BUSY )
+            {
+                break;
+            }
+            if( (data[0] & PCI_VALUE_MASK) != ch.rxSn )
+            {
+                ch.rxStatus = STATUS_SEQUENCE;
+                break;
+            }
+            size_t size( ch.rxSize - ch.rxOffset );
+            if( size > CF_DATA_SIZE )
+            {
+                size = CF_DATA_SIZE;
+            }
+            if( size >= dlc )
+            {
+                break;
+            }
+            for(size_t i(0); i<size; i++)
+            {
+                ch.rxBuffer[ch.rxOffset++] = data[1 + i];
+            }
+            ch.rxSn = (ch.rxSn + 1) & PCI_VALUE_MASK;
+            if( ch.rxOffset == ch.rxSize )
+            {
+                ch.rxStatus = STATUS_DONE;
+                break;
+            }
+            ch.rxTime = time + TIMEOUT;
+            if( ch.blockSize != 0 && ++ch.rxBlockCount == ch.blockSize )
+            {
+                ch.rxBlockCount = 0;
+                static_cast<void>( sendFlowControl(ch, FC_CTS) );
+            }
+            break;
+        }
+        case PCI_TYPE_FC:
+        {
+            if( ch.txStep != STEP_WAIT_FC || dlc < 3 )
+            {
+                break;
+            }
+            switch( data[0] & PCI_VALUE_MASK )
+            {
+                case FC_CTS:
+                {
+                    ch.txBlockSize = data[1];
+                    ch.txBlockCount = 0;
+                    ch.txStMin = toMicroseconds(data[2]);
+                    ch.txStep = STEP_SEND_CF;
+                    ch.txTime = time;
+                    // Start the block at once not to wait for next process() call
+                    static_cast<void>( sendConsecutive(ch, time) );
+                    break;
+                }
+                case FC_WAIT:
+                {
+                    ch.txTime = time + TIMEOUT;
+                    break;
+                }
+                case FC_OVERFLOW:
+                {
+                    ch.txStep = STEP_NONE;
+                    ch.txStatus = STATUS_OVERFLOW;
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+int32_t CanIsoTp::sendConsecutive(Channel& ch, uint32_t time)
+{
+    int32_t count( 0 );
+    while( ch.txStep == STEP_SEND_CF && isExpired(time, ch.txTime) )
+    {
+        size_t size( ch.txSize - ch.txOffset );
+        if( size > CF_DATA_SIZE )
+        {
+            size = CF_DATA_SIZE;
+        }
+        uint8_t const pci( PCI_TYPE_CF | ch.txSn );
+        if( !transmit(ch, &pci, 1, ch.txData + ch.txOffset, size) )
+        {
+            // No free mailbox, so try the frame again on next call
+            break;
+        }
+        count++;
+        ch.txOffset += size;
+        ch.txSn = (ch.txSn + 1) & PCI_VALUE_MASK;
+        if( ch.txOffset == ch.txSize )
+        {
+            ch.txStep = STEP_NONE;
+            ch.txStatus = STATUS_DONE;
+        }
+        else if( ch.txBlockSize != 0 && ++ch.txBlockCount == ch.txBlockSize )
+        {
+            ch.txBlockCount = 0;
+            ch.txStep = STEP_WAIT_FC;
+            ch.txTime = timebase_.getTime() + TIMEOUT;
+        }
+        else if( ch.txStMin != 0 )
+        {
+            ch.txTime = timebase_.getTime() + ch.txStMin;
+        }
+        else
+        {
+            // Next frame back-to-back
+        }
+    }
+    return count;
+}
+
+bool_t CanIsoTp::sendFlowControl(Channel& ch, uint8_t flag)
+{
+    uint8_t const pci[3] = { static_cast<uint8_t>(PCI_TYPE_FC | flag), ch.blockSize, ch.stMin };
+    bool_t const res( transmit(ch, pci, 3, NULLPTR, 0) );
+    ch.isFcPending = !res;
+    ch.fcFlag = flag;
+    return res;
+}
+
+bool_t CanIsoTp::transmit(Channel& ch, uint8_t const* pci, int32_t size, uint8_t const* data, size_t length)
+{
+    Can::Frame frame;
+    frame.ir = ch.txIr;
+    frame.dtr = 8;
+    int32_t index( 0 );
+    for(int32_t i(0); i<size; i++)
+    {
+        frame.data.v8[index++] = pci[i];
+    }
+    for(size_t i(0); i<length; i++)
+    {
+        frame.data.v8[index++] = data[i];
+    }
+    while( index < 8 )
+    {
+        frame.data.v8[index++] = PADDING;
+    }
+    // Do not wait for a free mailbox, and let the caller try the frame again
+    if( can_.isSleeping() )
+    {
+        static_cast<void>( can_.wakeUp() );
+    }
+    return can_.forward(frame);
+}
+
+uint32_t CanIsoTp::toIr(uint32_t id, bool_t isExtended)
+{
+    uint32_t ir( 0 );
+    if( isExtended )
+    {
+        ir = ( (id & 0x1FFFFFFF) << Can::Frame::IR_EXID_POS ) | Can::Frame::IR_IDE_MASK;
+    }
+    else
+    {
+        ir = (id & 0x000007FF) << Can::Frame::IR_STID_POS;
+    }
+    return ir;
+}
+
+uint32_t CanIsoTp::toMicroseconds(uint8_t stMin)
+{
+    uint32_t time( 127000 );
+    if( stMin <= 0x7F )
+    {
+        time = static_cast<uint32_t>(stMin) * 1000;
+    }
+    else if( stMin >= 0xF1 && stMin <= 0xF9 )
+    {
+        time = static_cast<uint32_t>(stMin - 0xF0) * 100;
+    }
+    else
+    {
+        // Reserved values are treated as the maximum
+    }
+    return time;
+}
+
+bool_t CanIsoTp::isExpired(uint32_t time, uint32_t when)
+{
+    return ( static_cast<int32_t>(time - when) >= 0 ) ? true : false;
+}
+
+} // namespace drv
+} // namespace eoos
@@ -0,0 +1,823 @@
+/**
+ * @file      drv.CanJ1939.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanJ1939.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanJ1939::CanJ1939(Can& can, CanTimebase& timebase, uint64_t name, uint8_t address)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , can_( can )
+    , timebase_( timebase )
+    , name_( name )
+    , address_( address )
+    , claim_( CLAIM_NONE )
+    , claimTime_( 0 )
+    , attempts_( 0 )
+    , isAddressPending_( false ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanJ1939::~CanJ1939()
+{
+}
+
+bool_t CanJ1939::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanJ1939::decode(Can::Frame const& frame, Id* id)
+{
+    bool_t res( false );
+    if( id != NULLPTR && (frame.ir & Can::Frame::IR_IDE_MASK) != 0 )
+    {
+        uint32_t const value( frame.ir >> Can::Frame::IR_EXID_POS );
+        id->priority = static_cast<uint8_t>( (value >> 26) & 0x7 );
+        id->sa = static_cast<uint8_t>( value );
+        if( ( (value >> 16) & 0xFF ) < PF_PDU2 )
+        {
+            id->pgn = (value >> 8) & 0x3FF00;
+            id->da = static_cast<uint8_t>( value >> 8 );
+        }
+        else
+        {
+            id->pgn = (value >> 8) & 0x3FFFF;
+            id->da = ADDRESS_GLOBAL;
+        }
+        res = true;
+    }
+    return res;
+}
+
+void CanJ1939::encode(Id const& id, Can::Frame* frame)
+{
+    uint32_t value( (static_cast<uint32_t>(id.priority & 0x7) << 26) | ((id.pgn & 0x3FFFF) << 8) | id.sa );
+    if( isPdu1(id.pgn) )
+    {
+        value = (value & 0xFFFF00FF) | (static_cast<uint32_t>(id.da) << 8);
+    }
+    frame->ir = (value << Can::Frame::IR_EXID_POS) | Can::Frame::IR_IDE_MASK;
+}
+
+bool_t CanJ1939::setHandler(uint32_t pgn, Handler& handler)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        Registration* free( NULLPTR );
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PGNS; i++)
+        {
+            if( handlers_[i].handler != NULLPTR && handlers_[i].pgn == pgn )
+            {
+                free = &handlers_[i];
+                break;
+            }
+            if( handlers_[i].handler == NULLPTR && free == NULLPTR )
+            {
+                free = &handlers_[i];
+            }
+        }
+        if( free != NULLPTR )
+        {
+            free->pgn = pgn;
+            free->handler = &handler;
+            res = true;
+        }
+    }
+    return res;
+}
+
+bool_t CanJ1939::setReceiveFilters(Can::RxFilter::Fifo fifo, uint32_t index)
+{
+    uint32_t const RESERVED_PGNS[4] = { PGN_REQUEST, PGN_TP_DT, PGN_TP_CM, PGN_ADDRESS };
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        uint32_t pgns[4 + MAXIMUM_NUMBER_OF_PGNS];
+        uint32_t count( 0 );
+        for(int32_t i(0); i<4; i++)
+        {
+            pgns[count++] = RESERVED_PGNS[i];
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PGNS; i++)
+        {
+            if( handlers_[i].handler != NULLPTR )
+            {
+                pgns[count++] = handlers_[i].pgn;
+            }
+        }
+        if( index + count > Can::RxFilter::NUMBER_OF_FILTER_GROUPS )
+        {
+            break;
+        }
+        res = true;
+        for(uint32_t i(0); i<count; i++)
+        {
+            // PDU1 filters pass any destination, which is tested by the handle() function
+            uint32_t const mask( isPdu1(pgns[i]) ? 0x03FF0000 : 0x03FFFF00 );
+            Can::RxFilter filter;
+            filter.fifo = fifo;
+            filter.index = index + i;
+            filter.mode = Can::RxFilter::MODE_IDMASK;
+            filter.scale = Can::RxFilter::SCALE_32BIT;
+            filter.filters.group32.idMask.id.value = ( (pgns[i] << 8) << Can::Frame::IR_EXID_POS ) | Can::Frame::IR_IDE_MASK;
+            filter.filters.group32.idMask.mask.value = ( mask << Can::Frame::IR_EXID_POS ) | Can::Frame::IR_IDE_MASK | Can::Frame::IR_RTR_MASK;
+            if( !can_.setReceiveFilter(filter) )
+            {
+                res = false;
+                break;
+            }
+        }
+    } while(false);
+    return res;
+}
+
+bool_t CanJ1939::claim()
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        claim_ = CLAIM_PENDING;
+        claimTime_ = timebase_.getTime() + TIMEOUT_CLAIM;
+        attempts_ = 0;
+        res = sendAddress();
+    }
+    return res;
+}
+
+CanJ1939::Claim CanJ1939::getClaim() const
+{
+    return claim_;
+}
+
+uint8_t CanJ1939::getAddress() const
+{
+    uint8_t address( ADDRESS_NULL );
+    if( claim_ == CLAIM_DONE )
+    {
+        address = address_;
+    }
+    return address;
+}
+
+bool_t CanJ1939::send(uint32_t pgn, uint8_t priority, uint8_t da, uint8_t const* data, size_t size)
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() || claim_ != CLAIM_DONE )
+        {
+            break;
+        }
+        if( data == NULLPTR || size == 0 || size > MAXIMUM_MESSAGE_SIZE )
+        {
+            break;
+        }
+        if( !isPdu1(pgn) )
+        {
+            da = ADDRESS_GLOBAL;
+        }
+        if( size <= 8 )
+        {
+            res = transmit(pgn, priority, da, data, size);
+            break;
+        }
+        // One session is allowed to one destination
+        TxSession* session( findTxSession(da) );
+        if( session != NULLPTR && session->step != STEP_NONE )
+        {
+            break;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS && session == NULLPTR; i++)
+        {
+            if( txSessions_[i].step == STEP_NONE )
+            {
+                session = &txSessions_[i];
+            }
+        }
+        if( session == NULLPTR )
+        {
+            break;
+        }
+        uint8_t const packets( static_cast<uint8_t>( (size + PACKET_SIZE - 1) / PACKET_SIZE ) );
+        uint8_t control( CM_RTS );
+        if( da == ADDRESS_GLOBAL )
+        {
+            control = CM_BAM;
+        }
+        if( !sendConnection(da, control, static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8), packets, 0xFF, pgn) )
+        {
+            break;
+        }
+        uint32_t const time( timebase_.getTime() );
+        session->pgn = pgn;
+        session->priority = priority;
+        session->da = da;
+        session->data = data;
+        session->size = size;
+        session->packets = packets;
+        session->next = 1;
+        session->status = STATUS_BUSY;
+        if( da == ADDRESS_GLOBAL )
+        {
+            session->last = packets;
+            session->step = STEP_SEND_DT;
+            session->time = time + TIME_BAM;
+        }
+        else
+        {
+            session->last = 0;
+            session->step = STEP_WAIT_CTS;
+            session->time = time + TIMEOUT_T3;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+CanJ1939::Status CanJ1939::getTxStatus(uint8_t da) const
+{
+    Status status( STATUS_IDLE );
+    for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+    {
+        if( txSessions_[i].da == da )
+        {
+            status = txSessions_[i].status;
+            break;
+        }
+    }
+    return status;
+}
+
+bool_t CanJ1939::handle(Can::Frame const& frame)
+{
+    bool_t res( false );
+    Id id;
+    if( isConstructed() && (frame.ir & Can::Frame::IR_RTR_MASK) == 0 && decode(frame, &id) )
+    {
+        bool_t const isOwn( claim_ == CLAIM_DONE && id.da == address_ );
+        size_t const dlc( frame.dtr & Can::Frame::DTR_DLC_MASK );
+        uint8_t const* const data( frame.data.v8 );
+        if( id.da == ADDRESS_GLOBAL || isOwn )
+        {
+            res = true;
+            switch( id.pgn )
+            {
+                case PGN_ADDRESS:
+                {
+                    if( dlc == 8 )
+                    {
+                        handleAddress(id, data);
+                    }
+                    break;
+                }
+                case PGN_REQUEST:
+                {
+                    uint32_t const pgn( (dlc >= 3) ? (data[0] | (data[1] << 8) | (data[2] << 16)) : 0 );
+                    if( pgn == PGN_ADDRESS && claim_ != CLAIM_NONE )
+                    {
+                        static_cast<void>( sendAddress() );
+                    }
+                    else
+                    {
+                        dispatch(id, data, dlc);
+                    }
+                    break;
+                }
+                case PGN_TP_CM:
+                {
+                    if( dlc == 8 )
+                    {
+                        handleConnection(id, data);
+                    }
+                    break;
+                }
+                case PGN_TP_DT:
+                {
+                    if( dlc == 8 )
+                    {
+                        handleData(id, data);
+                    }
+                    break;
+                }
+                default:
+                {
+                    dispatch(id, data, dlc);
+                    break;
+                }
+            }
+        }
+    }
+    return res;
+}
+
+int32_t CanJ1939::process()
+{
+    int32_t count( 0 );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        if( claim_ == CLAIM_PENDING && isExpired(time, claimTime_) )
+        {
+            claim_ = CLAIM_DONE;
+        }
+        if( isAddressPending_ && sendAddress() )
+        {
+            count++;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+        {
+            TxSession& session( txSessions_[i] );
+            if( (session.step == STEP_WAIT_CTS || session.step == STEP_WAIT_ACK) && isExpired(time, session.time) )
+            {
+                static_cast<void>( sendConnection(session.da, CM_ABORT, ABORT_TIMEOUT, 0xFF, 0xFF, 0xFF, session.pgn) );
+                session.step = STEP_NONE;
+                session.status = STATUS_TIMEOUT;
+            }
+            count += sendData(session, time);
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+        {
+            RxSession& session( rxSessions_[i] );
+            if( session.step == STEP_RECEIVE && isExpired(time, session.time) )
+            {
+                if( !session.isBam )
+                {
+                    static_cast<void>( sendConnection(session.sa, CM_ABORT, ABORT_TIMEOUT, 0xFF, 0xFF, 0xFF, session.pgn) );
+                }
+                session.step = STEP_NONE;
+                session.isResponsePending = false;
+            }
+            if( session.isResponsePending && sendResponse(session) )
+            {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+uint32_t CanJ1939::getDelay()
+{
+    uint32_t delay( TIMEOUT_TR );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        uint32_t diff( delay );
+        if( claim_ == CLAIM_PENDING )
+        {
+            diff = isExpired(time, claimTime_) ? 0 : (claimTime_ - time);
+            delay = (diff < delay) ? diff : delay;
+        }
+        if( isAddressPending_ )
+        {
+            delay = 0;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+        {
+            if( txSessions_[i].step != STEP_NONE )
+            {
+                diff = isExpired(time, txSessions_[i].time) ? 0 : (txSessions_[i].time - time);
+                delay = (diff < delay) ? diff : delay;
+            }
+            if( rxSessions_[i].step != STEP_NONE )
+            {
+                diff = isExpired(time, rxSessions_[i].time) ? 0 : (rxSessions_[i].time - time);
+                delay = (diff < delay) ? diff : delay;
+            }
+            if( rxSessions_[i].isResponsePending )
+            {
+                delay = 0;
+            }
+        }
+    }
+    return delay;
+}
+
+bool_t CanJ1939::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !can_.isConstructed() )
+        {
+            break;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PGNS; i++)
+        {
+            handlers_[i].pgn = 0;
+            handlers_[i].handler = NULLPTR;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+        {
+            txSessions_[i].step = STEP_NONE;
+            txSessions_[i].status = STATUS_IDLE;
+            txSessions_[i].da = ADDRESS_NULL;
+            rxSessions_[i].step = STEP_NONE;
+            rxSessions_[i].isResponsePending = false;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+void CanJ1939::handleConnection(Id const& id, uint8_t const* data)
+{
+    uint32_t const pgn( data[5] | (data[6] << 8) | (data[7] << 16) );
+    uint32_t const time( timebase_.getTime() );
+    switch( data[0] )
+    {
+        case CM_BAM:
+        case CM_RTS:
+        {
+            bool_t const isBam( data[0] == CM_BAM );
+            if( isBam != (id.da == ADDRESS_GLOBAL) )
+            {
+                break;
+            }
+            size_t const size( data[1] | (data[2] << 8) );
+            uint8_t const packets( data[3] );
+            if( size <= 8 || packets != (size + PACKET_SIZE - 1) / PACKET_SIZE )
+            {
+                break;
+            }
+            // A new announce from the same source replaces the session in progress
+            RxSession* session( findRxSession(id.sa, isBam) );
+            for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS && session == NULLPTR; i++)
+            {
+                if( rxSessions_[i].step == STEP_NONE )
+                {
+                    session = &rxSessions_[i];
+                }
+            }
+            if( session == NULLPTR || size > MAXIMUM_MESSAGE_SIZE )
+            {
+                if( !isBam )
+                {
+                    uint8_t reason( ABORT_RESOURCE );
+                    if( session == NULLPTR )
+                    {
+                        reason = ABORT_BUSY;
+                    }
+                    static_cast<void>( sendConnection(id.sa, CM_ABORT, reason, 0xFF, 0xFF, 0xFF, pgn) );
+                }
+                break;
+            }
+            session->pgn = pgn;
+            session->priority = id.priority;
+            session->sa = id.sa;
+            session->isBam = isBam;
+            session->size = size;
+            session->packets = packets;
+            session->next = 1;
+            session->window = data[4];
+            if( isBam || session->window == 0 )
+            {
+                session->window = packets;
+            }
+            session->last = (session->window < packets) ? session->window : packets;
+            session->step = STEP_RECEIVE;
+            session->isResponsePending = false;
+            if( isBam )
+            {
+                session->time = time + TIMEOUT_T1;
+            }
+            else
+            {
+                session->time = time + TIMEOUT_T2;
+                static_cast<void>( sendResponse(*session) );
+            }
+            break;
+        }
+        case CM_CTS:
+        {
+            TxSession* const session( findTxSession(id.sa) );
+            if( session == NULLPTR || session->step != STEP_WAIT_CTS || session->pgn != pgn )
+            {
+                break;
+            }
+            uint32_t const count( data[1] );
+            uint32_t const next( data[2] );
+            if( count == 0 )
+            {
+                // The receiver holds the connection open
+                session->time = time + TIMEOUT_T4;
+                break;
+            }
+            if( next == 0 || next > session->packets )
+            {
+                break;
+            }
+            uint32_t const last( next + count - 1 );
+            session->next = static_cast<uint8_t>( next );
+            session->last = static_cast<uint8_t>( (last < session->packets) ? last : session->packets );
+            session->step = STEP_SEND_DT;
+            session->time = time;
+            // Send the window at once not to wait for next process() call
+            static_cast<void>( sendData(*session, time) );
+            break;
+        }
+        case CM_ACK:
+        {
+            TxSession* const session( findTxSession(id.sa) );
+            if( session != NULLPTR && session->step == STEP_WAIT_ACK && session->pgn == pgn )
+            {
+                session->step = STEP_NONE;
+                session->status = STATUS_DONE;
+            }
+            break;
+        }
+        case CM_ABORT:
+        {
+            TxSession* const tx( findTxSession(id.sa) );
+            if( tx != NULLPTR && tx->step != STEP_NONE && tx->pgn == pgn )
+            {
+                tx->step = STEP_NONE;
+                tx->status = STATUS_ABORTED;
+            }
+            RxSession* const rx( findRxSession(id.sa, false) );
+            if( rx != NULLPTR && rx->pgn == pgn )
+            {
+                rx->step = STEP_NONE;
+                rx->isResponsePending = false;
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+void CanJ1939::handleData(Id const& id, uint8_t const* data)
+{
+    bool_t const isBam( id.da == ADDRESS_GLOBAL );
+    RxSession* const session( findRxSession(id.sa, isBam) );
+    // A lost or repeated packet is skipped, and the session is timed out if the sender does not resend
+    if( session != NULLPTR && data[0] == session->next )
+    {
+        size_t const offset( static_cast<size_t>(session->next - 1) * PACKET_SIZE );
+        size_t size( session->size - offset );
+        if( size > PACKET_SIZE )
+        {
+            size = PACKET_SIZE;
+        }
+        for(size_t i(0); i<size; i++)
+        {
+            session->buffer[offset + i] = data[1 + i];
+        }
+        uint32_t const time( timebase_.getTime() );
+        if( session->next == session->packets )
+        {
+            session->step = STEP_NONE;
+            if( !isBam )
+            {
+                static_cast<void>( sendResponse(*session) );
+            }
+            Id const message = { session->priority, session->pgn, session->sa, id.da };
+            dispatch(message, session->buffer, session->size);
+        }
+        else if( !isBam && session->next == session->last )
+        {
+            session->next++;
+            uint32_t const last( static_cast<uint32_t>(session->next) + session->window - 1 );
+            session->last = static_cast<uint8_t>( (last < session->packets) ? last : session->packets );
+            session->time = time + TIMEOUT_T2;
+            static_cast<void>( sendResponse(*session) );
+        }
+        else
+        {
+            session->next++;
+            session->time = time + TIMEOUT_T1;
+        }
+    }
+}
+
+void CanJ1939::handleAddress(Id const& id, uint8_t const* data)
+{
+    if( (claim_ == CLAIM_PENDING || claim_ == CLAIM_DONE) && id.sa == address_ )
+    {
+        uint64_t name( 0 );
+        for(int32_t i(7); i>=0; i--)
+        {
+            name = (name << 8) | data[i];
+        }
+        if( name_ == name )
+        {
+            // The frame is of this application echoed by a loopback
+        }
+        else if( name_ < name )
+        {
+            // This NAME has priority, so the address is defended
+            static_cast<void>( sendAddress() );
+        }
+        else if( (name_ >> 63) != 0 && attempts_ < (ADDRESS_LAST - ADDRESS_FIRST) )
+        {
+            // The NAME is arbitrary address capable
+            attempts_++;
+            if( address_ < ADDRESS_FIRST || address_ >= ADDRESS_LAST )
+            {
+                address_ = ADDRESS_FIRST;
+            }
+            else
+            {
+                address_++;
+            }
+            claim_ = CLAIM_PENDING;
+            claimTime_ = timebase_.getTime() + TIMEOUT_CLAIM;
+            static_cast<void>( sendAddress() );
+        }
+        else
+        {
+            claim_ = CLAIM_FAILED;
+            static_cast<void>( sendAddress() );
+        }
+    }
+}
+
+void CanJ1939::dispatch(Id const& id, uint8_t const* data, size_t size)
+{
+    for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PGNS; i++)
+    {
+        if( handlers_[i].handler != NULLPTR && handlers_[i].pgn == id.pgn )
+        {
+            handlers_[i].handler->handle(id, data, size);
+            break;
+        }
+    }
+}
+
+int32_t CanJ1939::sendData(TxSession& session, uint32_t time)
+{
+    int32_t count( 0 );
+    while( session.step == STEP_SEND_DT && isExpired(time, session.time) )
+    {
+        uint8_t packet[8];
+        size_t const offset( static_cast<size_t>(session.next - 1) * PACKET_SIZE );
+        size_t size( session.size - offset );
+        if( size > PACKET_SIZE )
+        {
+            size = PACKET_SIZE;
+        }
+        packet[0] = session.next;
+        for(size_t i(0); i<size; i++)
+        {
+            packet[1 + i] = session.data[offset + i];
+        }
+        if( !transmit(PGN_TP_DT, PRIORITY_TP, session.da, packet, size + 1) )
+        {
+            // No free mailbox, so try the packet again on next call
+            break;
+        }
+        count++;
+        if( session.next == session.packets )
+        {
+            if( session.da == ADDRESS_GLOBAL )
+            {
+                session.step = STEP_NONE;
+                session.status = STATUS_DONE;
+            }
+            else
+            {
+                session.step = STEP_WAIT_ACK;
+                session.time = timebase_.getTime() + TIMEOUT_T3;
+            }
+        }
+        else if( session.next == session.last )
+        {
+            session.step = STEP_WAIT_CTS;
+            session.time = timebase_.getTime() + TIMEOUT_T3;
+        }
+        else if( session.da == ADDRESS_GLOBAL )
+        {
+            session.time = timebase_.getTime() + TIME_BAM;
+        }
+        else
+        {
+            // Next packet of the window back-to-back
+        }
+        session.next++;
+    }
+    return count;
+}
+
+bool_t CanJ1939::sendConnection(uint8_t da, uint8_t control, uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint32_t pgn)
+{
+    uint8_t const data[8] = {
+        control, a, b, c, d,
+        static_cast<uint8_t>( pgn       ),
+        static_cast<uint8_t>( pgn >> 8  ),
+        static_cast<uint8_t>( pgn >> 16 )
+    };
+    return transmit(PGN_TP_CM, PRIORITY_TP, da, data, sizeof(data));
+}
+
+bool_t CanJ1939::sendAddress()
+{
+    uint8_t data[8];
+    for(int32_t i(0); i<8; i++)
+    {
+        data[i] = static_cast<uint8_t>( name_ >> (i * 8) );
+    }
+    bool_t const res( transmit(PGN_ADDRESS, PRIORITY_NM, ADDRESS_GLOBAL, data, sizeof(data)) );
+    isAddressPending_ = !res;
+    return res;
+}
+
+bool_t CanJ1939::sendResponse(RxSession& session)
+{
+    bool_t res( false );
+    if( session.step == STEP_RECEIVE )
+    {
+        res = sendConnection(session.sa, CM_CTS, static_cast<uint8_t>(session.last - session.next + 1), session.next, 0xFF, 0xFF, session.pgn);
+    }
+    else
+    {
+        res = sendConnection(session.sa, CM_ACK, static_cast<uint8_t>(session.size), static_cast<uint8_t>(session.size >> 8), session.packets, 0xFF, session.pgn);
+    }
+    session.isResponsePending = !res;
+    return res;
+}
+
+bool_t CanJ1939::transmit(uint32_t pgn, uint8_t priority, uint8_t da, uint8_t const* data, size_t size)
+{
+    Id id = { priority, pgn, address_, da };
+    if( claim_ == CLAIM_FAILED )
+    {
+        id.sa = ADDRESS_NULL;
+    }
+    Can::Frame frame;
+    encode(id, &frame);
+    frame.dtr = 8;
+    for(size_t i(0); i<8; i++)
+    {
+        frame.data.v8[i] = PADDING;
+        if( i < size )
+        {
+            frame.data.v8[i] = data[i];
+        }
+    }
+    // Do not wait for a free mailbox, and let the caller try the frame again
+    if( can_.isSleeping() )
+    {
+        static_cast<void>( can_.wakeUp() );
+    }
+    return can_.forward(frame);
+}
+
+CanJ1939::RxSession* CanJ1939::findRxSession(uint8_t sa, bool_t isBam)
+{
+    RxSession* session( NULLPTR );
+    for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+    {
+        if( rxSessions_[i].step != STEP_NONE && rxSessions_[i].sa == sa && rxSessions_[i].isBam == isBam )
+        {
+            session = &rxSessions_[i];
+            break;
+        }
+    }
+    return session;
+}
+
+CanJ1939::TxSession* CanJ1939::findTxSession(uint8_t da)
+{
+    TxSession* session( NULLPTR );
+    for(int32_t i(0); i<MAXIMUM_NUMBER_OF_SESSIONS; i++)
+    {
+        if( txSessions_[i].da == da )
+        {
+            session = &txSessions_[i];
+            break;
+        }
+    }
+    return session;
+}
+
+bool_t CanJ1939::isPdu1(uint32_t pgn)
+{
+    return ( ((pgn >> 8) & 0xFF) < PF_PDU2 ) ? true : false;
+}
+
+bool_t CanJ1939::isExpired(uint32_t time, uint32_t when)
+{
+    return ( static_cast<int32_t>(time - when) >= 0 ) ? true : false;
+}
+
+} // namespace drv
+} // namespace eoos
@@ -0,0 +1,257 @@
+/**
+ * @file      drv.CanMonitor.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanMonitor.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanMonitor::CanMonitor(CanTimebase& timebase, uint32_t tick, Handler& handler)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , timebase_( timebase )
+    , tick_( tick )
+    , handler_( handler )
+    , count_( 0 )
+    , current_( 0 )
+    , currentTime_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanMonitor::~CanMonitor()
+{
+}
+
+bool_t CanMonitor::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+int32_t CanMonitor::watch(uint32_t id, bool_t isExtended, uint32_t timeout)
+{
+    int32_t index( NONE );
+    do
+    {
+        if( !isConstructed() || count_ >= MAXIMUM_NUMBER_OF_WATCHES || timeout == 0 )
+        {
+            break;
+        }
+        uint32_t key( id << Can::Frame::IR_STID_POS );
+        if( isExtended )
+        {
+            key = (id << Can::Frame::IR_EXID_POS) | Can::Frame::IR_IDE_MASK;
+        }
+        key &= KEY_MASK;
+        uint32_t const bucket( hash(key) );
+        bool_t isWatched( false );
+        for(int32_t i( buckets_[bucket] ); i != NONE; i = watches_[i].chain)
+        {
+            if( watches_[i].key == key )
+            {
+                isWatched = true;
+                break;
+            }
+        }
+        if( isWatched )
+        {
+            break;
+        }
+        index = count_;
+        Watch& w( watches_[index] );
+        uint32_t const time( timebase_.getTime() );
+        w.key = key;
+        w.timeout = timeout;
+        w.ticks = (timeout + tick_ - 1) / tick_;
+        w.time = time;
+        w.isFired = false;
+        w.chain = buckets_[bucket];
+        schedule(index, current_ + (time - currentTime_ + timeout + tick_ - 1) / tick_);
+        // Publish the watch to the interrupts after it is completed
+        __sync_synchronize();
+        buckets_[bucket] = index;
+        count_++;
+    } while(false);
+    return index;
+}
+
+bool_t CanMonitor::isTimeout(int32_t watch)
+{
+    bool_t res( false );
+    if( isConstructed() && watch >= 0 && watch < count_ )
+    {
+        Watch const& w( watches_[watch] );
+        res = isExpired(timebase_.getTime(), w.time + w.timeout);
+    }
+    return res;
+}
+
+bool_t CanMonitor::refresh(Can::Frame const& frame)
+{
+    bool_t res( false );
+    uint32_t const key( frame.ir & KEY_MASK );
+    for(int32_t i( buckets_[hash(key)] ); i != NONE; i = watches_[i].chain)
+    {
+        if( watches_[i].key == key )
+        {
+            watches_[i].time = timebase_.getTime();
+            res = true;
+            break;
+        }
+    }
+    return res;
+}
+
+int32_t CanMonitor::process()
+{
+    int32_t count( 0 );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        while( isExpired(time, currentTime_ + tick_) )
+        {
+            currentTime_ += tick_;
+            current_++;
+            count += advance();
+        }
+    }
+    return count;
+}
+
+bool_t CanMonitor::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !timebase_.isConstructed() || tick_ == 0 )
+        {
+            break;
+        }
+        for(uint32_t i(0); i<NUMBER_OF_BUCKETS; i++)
+        {
+            buckets_[i] = NONE;
+        }
+        for(int32_t i(0); i<NUMBER_OF_LEVELS; i++)
+        {
+            for(uint32_t j(0); j<NUMBER_OF_SLOTS; j++)
+            {
+                slots_[i][j] = NONE;
+            }
+        }
+        currentTime_ = timebase_.getTime();
+        res = true;
+    } while(false);
+    return res;
+}
+
+int32_t CanMonitor::advance()
+{
+    int32_t count( 0 );
+    uint32_t const tick( current_ );
+    if( (tick & SLOT_MASK) == 0 )
+    {
+        if( ((tick >> SLOT_BITS) & SLOT_MASK) == 0 )
+        {
+            cascade( slots_[2][(tick >> (SLOT_BITS * 2)) & SLOT_MASK] );
+        }
+        cascade( slots_[1][(tick >> SLOT_BITS) & SLOT_MASK] );
+    }
+    int32_t& slot( slots_[0][tick & SLOT_MASK] );
+    int32_t index( slot );
+    slot = NONE;
+    while( index != NONE )
+    {
+        int32_t const next( watches_[index].next );
+        if( check(index) )
+        {
+            count++;
+        }
+        index = next;
+    }
+    return count;
+}
+
+void CanMonitor::cascade(int32_t& slot)
+{
+    int32_t index( slot );
+    slot = NONE;
+    while( index != NONE )
+    {
+        int32_t const next( watches_[index].next );
+        schedule(index, watches_[index].deadline);
+        index = next;
+    }
+}
+
+bool_t CanMonitor::check(int32_t index)
+{
+    bool_t res( false );
+    Watch& w( watches_[index] );
+    uint32_t const deadline( w.time + w.timeout );
+    if( isExpired(currentTime_, deadline) )
+    {
+        if( !w.isFired )
+        {
+            w.isFired = true;
+            handler_.handle(index);
+            res = true;
+        }
+        schedule(index, current_ + w.ticks);
+    }
+    else
+    {
+        // A frame has been received, so the watch is moved to its actual deadline
+        w.isFired = false;
+        schedule(index, current_ + (deadline - currentTime_ + tick_ - 1) / tick_);
+    }
+    return res;
+}
+
+void CanMonitor::schedule(int32_t index, uint32_t deadline)
+{
+    if( static_cast<int32_t>(deadline - current_) < 0 )
+    {
+        deadline = current_;
+    }
+    int32_t* slot( NULLPTR );
+    if( deadline - current_ < NUMBER_OF_SLOTS )
+    {
+        slot = &slots_[0][deadline & SLOT_MASK];
+    }
+    else if( (deadline >> SLOT_BITS) - (current_ >> SLOT_BITS) < NUMBER_OF_SLOTS )
+    {
+        slot = &slots_[1][(deadline >> SLOT_BITS) & SLOT_MASK];
+    }
+    else if( (deadline >> (SLOT_BITS * 2)) - (current_ >> (SLOT_BITS * 2)) < NUMBER_OF_SLOTS )
+    {
+        slot = &slots_[2][(deadline >> (SLOT_BITS * 2)) & SLOT_MASK];
+    }
+    else
+    {
+        // Beyond the wheel, so the watch is cascaded from the farthest slot again
+        slot = &slots_[2][((current_ >> (SLOT_BITS * 2)) + SLOT_MASK) & SLOT_MASK];
+    }
+    watches_[index].deadline = deadline;
+    watches_[index].next = *slot;
+    *slot = index;
+}
+
+uint32_t CanMonitor::hash(uint32_t key)
+{
+    return ( (key >> Can::Frame::IR_STID_POS) ^ (key >> Can::Frame::IR_EXID_POS) ) & (NUMBER_OF_BUCKETS - 1);
+}
+
+bool_t CanMonitor::isExpired(uint32_t time, uint32_t when)
+{
+    return ( static_cast<int32_t>(time - when) >= 0 ) ? true : false;
+}
+
+} // namespace drv
+} // namespace eoos
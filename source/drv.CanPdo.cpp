@@ -0,0 +1,389 @@
+/**
+ * @file      drv.CanPdo.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanPdo.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanPdo::CanPdo(Can& can, CanTimebase& timebase)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , can_( can )
+    , timebase_( timebase )
+    , syncTime_( 0 )
+    , latency_( 0 )
+    , maxLatency_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanPdo::~CanPdo()
+{
+}
+
+bool_t CanPdo::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+int32_t CanPdo::setRpdo(Pdo const& pdo)
+{
+    int32_t index( -1 );
+    if( isConstructed() && isMapping(pdo) )
+    {
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+        {
+            if( !rpdos_[i].isSet )
+            {
+                index = i;
+                break;
+            }
+        }
+    }
+    if( index != -1 )
+    {
+        Rpdo& rpdo( rpdos_[index] );
+        rpdo.pdo = pdo;
+        rpdo.ir = (pdo.cobId & 0x7FF) << Can::Frame::IR_STID_POS;
+        rpdo.isPending = false;
+        rpdo.data = 0;
+        rpdo.isSet = true;
+    }
+    return index;
+}
+
+int32_t CanPdo::setTpdo(Pdo const& pdo)
+{
+    int32_t index( -1 );
+    if( isConstructed() && isMapping(pdo) )
+    {
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+        {
+            if( !tpdos_[i].isSet )
+            {
+                index = i;
+                break;
+            }
+        }
+    }
+    if( index != -1 )
+    {
+        uint32_t const time( timebase_.getTime() );
+        Tpdo& tpdo( tpdos_[index] );
+        tpdo.pdo = pdo;
+        tpdo.ir = (pdo.cobId & 0x7FF) << Can::Frame::IR_STID_POS;
+        tpdo.isEvent = false;
+        tpdo.isPending = false;
+        tpdo.syncs = 0;
+        tpdo.inhibit = time;
+        tpdo.timer = time + pdo.eventTime;
+        tpdo.isSet = true;
+    }
+    return index;
+}
+
+bool_t CanPdo::trigger(int32_t tpdo)
+{
+    bool_t res( false );
+    if( isConstructed() && tpdo >= 0 && tpdo < MAXIMUM_NUMBER_OF_PDOS && tpdos_[tpdo].isSet )
+    {
+        tpdos_[tpdo].isEvent = true;
+        res = true;
+    }
+    return res;
+}
+
+bool_t CanPdo::handle(Can::Frame const& frame)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        uint32_t const key( frame.ir & IR_KEY_MASK );
+        if( key == (COBID_SYNC << Can::Frame::IR_STID_POS) )
+        {
+            sync();
+            res = true;
+        }
+        else
+        {
+            for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+            {
+                Rpdo& rpdo( rpdos_[i] );
+                if( !rpdo.isSet || rpdo.ir != key )
+                {
+                    continue;
+                }
+                // A frame shorter than the mapping is not applied
+                if( (frame.dtr & Can::Frame::DTR_DLC_MASK) >= rpdo.pdo.size )
+                {
+                    if( isSync(rpdo.pdo) )
+                    {
+                        rpdo.data = frame.data.v64[0];
+                        rpdo.isPending = true;
+                    }
+                    else
+                    {
+                        unpack(rpdo.pdo, frame.data.v64[0]);
+                    }
+                }
+                res = true;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+int32_t CanPdo::process()
+{
+    int32_t count( 0 );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+        {
+            Tpdo& tpdo( tpdos_[i] );
+            if( !tpdo.isSet )
+            {
+                continue;
+            }
+            if( tpdo.isPending )
+            {
+                if( transmit(tpdo) )
+                {
+                    tpdo.isPending = false;
+                    count++;
+                }
+            }
+            else if( !isSync(tpdo.pdo) )
+            {
+                bool_t const isTimer( tpdo.pdo.eventTime != 0 && isExpired(time, tpdo.timer) );
+                if( (tpdo.isEvent || isTimer) && isExpired(time, tpdo.inhibit) )
+                {
+                    if( transmit(tpdo) )
+                    {
+                        tpdo.isEvent = false;
+                        tpdo.inhibit = time + tpdo.pdo.inhibitTime;
+                        tpdo.timer = time + tpdo.pdo.eventTime;
+                        count++;
+                    }
+                }
+            }
+            else
+            {
+                // A synchronous TPDO is transmitted on SYNC
+            }
+        }
+    }
+    return count;
+}
+
+uint32_t CanPdo::getDelay()
+{
+    uint32_t delay( TIMEOUT );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+        {
+            Tpdo const& tpdo( tpdos_[i] );
+            if( !tpdo.isSet )
+            {
+                continue;
+            }
+            if( tpdo.isPending )
+            {
+                delay = 0;
+                break;
+            }
+            if( isSync(tpdo.pdo) )
+            {
+                continue;
+            }
+            if( tpdo.isEvent )
+            {
+                uint32_t const diff( isExpired(time, tpdo.inhibit) ? 0 : (tpdo.inhibit - time) );
+                delay = (diff < delay) ? diff : delay;
+            }
+            if( tpdo.pdo.eventTime != 0 )
+            {
+                uint32_t const diff( isExpired(time, tpdo.timer) ? 0 : (tpdo.timer - time) );
+                delay = (diff < delay) ? diff : delay;
+            }
+        }
+    }
+    return delay;
+}
+
+uint32_t CanPdo::getSyncLatency() const
+{
+    return latency_;
+}
+
+uint32_t CanPdo::getMaximumSyncLatency() const
+{
+    return maxLatency_;
+}
+
+bool_t CanPdo::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !can_.isConstructed() )
+        {
+            break;
+        }
+        for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+        {
+            rpdos_[i].isSet = false;
+            tpdos_[i].isSet = false;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+void CanPdo::sync()
+{
+    syncTime_ = timebase_.getTime();
+    // Transmit first to keep the latency short, as the RPDOs received do not change the TPDOs of this SYNC
+    for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+    {
+        Tpdo& tpdo( tpdos_[i] );
+        if( !tpdo.isSet || !isSync(tpdo.pdo) )
+        {
+            continue;
+        }
+        bool_t isDue( false );
+        if( tpdo.pdo.type == TYPE_SYNC_ACYCLIC )
+        {
+            isDue = tpdo.isEvent;
+        }
+        else
+        {
+            tpdo.syncs++;
+            if( tpdo.syncs >= tpdo.pdo.type )
+            {
+                tpdo.syncs = 0;
+                isDue = true;
+            }
+        }
+        if( isDue )
+        {
+            tpdo.isEvent = false;
+            tpdo.isPending = !transmit(tpdo);
+        }
+    }
+    for(int32_t i(0); i<MAXIMUM_NUMBER_OF_PDOS; i++)
+    {
+        Rpdo& rpdo( rpdos_[i] );
+        if( rpdo.isSet && rpdo.isPending )
+        {
+            unpack(rpdo.pdo, rpdo.data);
+            rpdo.isPending = false;
+        }
+    }
+}
+
+bool_t CanPdo::transmit(Tpdo& tpdo)
+{
+    Can::Frame frame;
+    frame.ir = tpdo.ir;
+    frame.dtr = tpdo.pdo.size;
+    frame.data.v64[0] = pack(tpdo.pdo);
+    // Do not wait for a free mailbox, and let the caller try the TPDO again
+    if( can_.isSleeping() )
+    {
+        static_cast<void>( can_.wakeUp() );
+    }
+    bool_t const res( can_.forward(frame) );
+    if( res && isSync(tpdo.pdo) )
+    {
+        latency_ = timebase_.getTime() - syncTime_;
+        if( latency_ > maxLatency_ )
+        {
+            maxLatency_ = latency_;
+        }
+    }
+    return res;
+}
+
+bool_t CanPdo::isSync(Pdo const& pdo)
+{
+    return ( pdo.type <= TYPE_SYNC_LAST ) ? true : false;
+}
+
+bool_t CanPdo::isMapping(Pdo const& pdo)
+{
+    bool_t res( false );
+    if( pdo.size <= 8 && (pdo.count == 0 || pdo.entries != NULLPTR) )
+    {
+        res = true;
+        for(int32_t i(0); i<pdo.count; i++)
+        {
+            Entry const& entry( pdo.entries[i] );
+            if( entry.object == NULLPTR || entry.length == 0 || entry.offset + entry.length > pdo.size * 8 )
+            {
+                res = false;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+void CanPdo::unpack(Pdo const& pdo, uint64_t data)
+{
+    for(int32_t i(0); i<pdo.count; i++)
+    {
+        Entry const& entry( pdo.entries[i] );
+        uint64_t value( data >> entry.offset );
+        if( entry.length < 64 )
+        {
+            value &= (static_cast<uint64_t>(1) << entry.length) - 1;
+        }
+        int32_t const size( (entry.length + 7) >> 3 );
+        for(int32_t j(0); j<size; j++)
+        {
+            entry.object[j] = static_cast<uint8_t>( value >> (j << 3) );
+        }
+    }
+}
+
+uint64_t CanPdo::pack(Pdo const& pdo)
+{
+    uint64_t data( 0 );
+    for(int32_t i(0); i<pdo.count; i++)
+    {
+        Entry const& entry( pdo.entries[i] );
+        uint64_t value( 0 );
+        int32_t const size( (entry.length + 7) >> 3 );
+        for(int32_t j(0); j<size; j++)
+        {
+            value |= static_cast<uint64_t>(entry.object[j]) << (j << 3);
+        }
+        if( entry.length < 64 )
+        {
+            value &= (static_cast<uint64_t>(1) << entry.length) - 1;
+        }
+        data |= value << entry.offset;
+    }
+    return data;
+}
+
+bool_t CanPdo::isExpired(uint32_t time, uint32_t when)
+{
+    return ( static_cast<int32_t>(time - when) >= 0 ) ? true : false;
+}
+
+} // namespace drv
+} // namespace eoos
@@ -0,0 +1,514 @@
+/**
+ * @file      drv.CanRecordConverter.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanRecordConverter.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanRecordConverter::CanRecordConverter(uint8_t const* log, size_t size, Format format)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , log_( log )
+    , size_( size )
+    , format_( format )
+    , pos_( 0 )
+    , time_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanRecordConverter::~CanRecordConverter()
+{
+}
+
+bool_t CanRecordConverter::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanRecordConverter::read(Record* record)
+{
+    bool_t res( false );
+    if( isConstructed() && record != NULLPTR )
+    {
+        if( format_ == FORMAT_BINARY )
+        {
+            res = readBinary(record);
+        }
+        if( format_ == FORMAT_CANDUMP )
+        {
+            res = readCandump(record);
+        }
+    }
+    return res;
+}
+
+void CanRecordConverter::rewind()
+{
+    pos_ = (format_ == FORMAT_BINARY) ? CanRecorder::LOG_HEADER_SIZE : 0;
+    time_ = 0;
+}
+
+bool_t CanRecordConverter::fromCandump(char_t const* line, size_t size, Record* record)
+{
+    bool_t res( false );
+    do
+    {
+        if( line == NULLPTR || record == NULLPTR )
+        {
+            break;
+        }
+        size_t pos( 0 );
+        while( pos < size && line[pos] == ' ' )
+        {
+            pos++;
+        }
+        // Time as (seconds.microseconds)
+        if( pos >= size || line[pos++] != '(' )
+        {
+            break;
+        }
+        uint64_t seconds( 0 );
+        if( parseDec(line, size, &pos, &seconds) == 0 )
+        {
+            break;
+        }
+        if( pos >= size || line[pos++] != '.' )
+        {
+            break;
+        }
+        uint64_t microseconds( 0 );
+        if( parseDec(line, size, &pos, &microseconds) != 6 )
+        {
+            break;
+        }
+        if( pos >= size || line[pos++] != ')' )
+        {
+            break;
+        }
+        // Interface name
+        while( pos < size && line[pos] == ' ' )
+        {
+            pos++;
+        }
+        while( pos < size && line[pos] != ' ' )
+        {
+            pos++;
+        }
+        while( pos < size && line[pos] == ' ' )
+        {
+            pos++;
+        }
+        // Identifier
+        uint32_t id( 0 );
+        int32_t const digits( parseHex(line, size, &pos, 8, &id) );
+        if( digits != 3 && digits != 8 )
+        {
+            break;
+        }
+        if( pos >= size || line[pos++] != '#' )
+        {
+            break;
+        }
+        Can::Message& message( record->message );
+        message.ide = (digits == 8) ? true : false;
+        if( message.ide )
+        {
+            message.id.stid = (id >> 18) & 0x7FF;
+            message.id.exid = id & 0x3FFFF;
+        }
+        else
+        {
+            message.id.stid = id & 0x7FF;
+            message.id.exid = 0;
+        }
+        message.rtr = false;
+        message.dlc = 0;
+        message.data.v64[0] = 0;
+        // Data or remote request
+        if( pos < size && line[pos] == 'R' )
+        {
+            message.rtr = true;
+            pos++;
+            uint32_t dlc( 0 );
+            if( parseHex(line, size, &pos, 1, &dlc) == 1 )
+            {
+                message.dlc = (dlc > 8) ? 8 : dlc;
+            }
+        }
+        else
+        {
+            uint32_t byte( 0 );
+            while( message.dlc < 8 && parseHex(line, size, &pos, 2, &byte) == 2 )
+            {
+                message.data.v8[message.dlc++] = static_cast<uint8_t>(byte);
+            }
+        }
+        record->time = seconds * 1000000 + microseconds;
+        record->source = CanRecorder::SOURCE_RXFIFO_0;
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanRecordConverter::readBinary(Record* record)
+{
+    bool_t res( false );
+    do
+    {
+        size_t pos( pos_ );
+        if( pos >= size_ )
+        {
+            break;
+        }
+        uint8_t const head( log_[pos++] );
+        // Time delta in unsigned LEB128
+        uint32_t delta( 0 );
+        int32_t shift( 0 );
+        bool_t isTime( false );
+        while( pos < size_ && shift < 35 )
+        {
+            uint8_t const byte( log_[pos++] );
+            delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+            if( (byte & 0x80) == 0 )
+            {
+                isTime = true;
+                break;
+            }
+        }
+        if( !isTime )
+        {
+            break;
+        }
+        Can::Message& message( record->message );
+        message.dlc = head & 0x0F;
+        message.rtr = ( (head & 0x10) != 0 ) ? true : false;
+        message.ide = ( (head & 0x20) != 0 ) ? true : false;
+        message.data.v64[0] = 0;
+        size_t const idSize( (message.ide) ? 4 : 2 );
+        size_t const dataSize( (message.rtr) ? 0 : message.dlc );
+        if( message.dlc > 8 || pos + idSize + dataSize > size_ )
+        {
+            break;
+        }
+        uint32_t id( 0 );
+        for(size_t i(0); i<idSize; i++)
+        {
+            id |= static_cast<uint32_t>(log_[pos++]) << (i * 8);
+        }
+        if( message.ide )
+        {
+            message.id.stid = (id >> 18) & 0x7FF;
+            message.id.exid = id & 0x3FFFF;
+        }
+        else
+        {
+            message.id.stid = id & 0x7FF;
+            message.id.exid = 0;
+        }
+        for(size_t i(0); i<dataSize; i++)
+        {
+            message.data.v8[i] = log_[pos++];
+        }
+        time_ += delta;
+        record->time = time_;
+        record->source = static_cast<CanRecorder::Source>( (head >> 6) & 0x3 );
+        pos_ = pos;
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanRecordConverter::readCandump(Record* record)
+{
+    bool_t res( false );
+    char_t const* const text( reinterpret_cast<char_t const*>(log_) );
+    while( !res && pos_ < size_ )
+    {
+        size_t end( pos_ );
+        while( end < size_ && text[end] != '\n' )
+        {
+            end++;
+        }
+        res = fromCandump(&text[pos_], end - pos_, record);
+        // Skip the line and its new line character
+        pos_ = (end < size_) ? end + 1 : end;
+    }
+    return res;
+}
+
+int32_t CanRecordConverter::toCandump(Record const& record, char_t const* interface, char_t* str, int32_t size)
+{
+    Can::Message const& message( record.message );
+    Text text(str, size);
+    text.put('(');
+    text.putDec(record.time / 1000000, 10, '0');
+    text.put('.');
+    text.putDec(record.time % 1000000, 6, '0');
+    text.put(") ");
+    text.put(interface);
+    text.put(' ');
+    if( message.ide )
+    {
+        text.putHex( (static_cast<uint32_t>(message.id.stid) << 18) | message.id.exid, 8 );
+    }
+    else
+    {
+        text.putHex( message.id.stid, 3 );
+    }
+    text.put('#');
+    if( message.rtr )
+    {
+        text.put('R');
+        // The data length of a remote request is kept as the candump parser reads it
+        if( message.dlc != 0 )
+        {
+            text.putHex(message.dlc, 1);
+        }
+    }
+    else
+    {
+        for(uint32_t i(0); i<message.dlc; i++)
+        {
+            text.putHex(message.data.v8[i], 2);
+        }
+    }
+    text.put('\n');
+    return text.end();
+}
+
+int32_t CanRecordConverter::toAsc(Record const& record, int32_t channel, char_t* str, int32_t size)
+{
+    Can::Message const& message( record.message );
+    Text text(str, size);
+    text.putDec(record.time / 1000000, 4, ' ');
+    text.put('.');
+    text.putDec(record.time % 1000000, 6, '0');
+    text.put(' ');
+    text.putDec(static_cast<uint64_t>(channel), 1, ' ');
+    text.put("  ");
+    if( message.ide )
+    {
+        text.putHex( (static_cast<uint32_t>(message.id.stid) << 18) | message.id.exid, 1 );
+        text.put('x');
+    }
+    else
+    {
+        text.putHex( message.id.stid, 1 );
+    }
+    text.put("             ");
+    text.put( (record.source == CanRecorder::SOURCE_TX) ? "Tx" : "Rx" );
+    text.put("   ");
+    if( message.rtr )
+    {
+        text.put("r ");
+        text.putDec(message.dlc, 1, ' ');
+    }
+    else
+    {
+        text.put("d ");
+        text.putDec(message.dlc, 1, ' ');
+        for(uint32_t i(0); i<message.dlc; i++)
+        {
+            text.put(' ');
+            text.putHex(message.data.v8[i], 2);
+        }
+    }
+    text.put('\n');
+    return text.end();
+}
+
+int32_t CanRecordConverter::toAscHeader(char_t* str, int32_t size)
+{
+    Text text(str, size);
+    text.put("date Thu Jan 1 00:00:00.000 am 1970\n");
+    text.put("base hex  timestamps absolute\n");
+    text.put("no internal events logged\n");
+    text.put("Begin Triggerblock Thu Jan 1 00:00:00.000 am 1970\n");
+    text.put("   0.000000 Start of measurement\n");
+    return text.end();
+}
+
+int32_t CanRecordConverter::toAscFooter(char_t* str, int32_t size)
+{
+    Text text(str, size);
+    text.put("End TriggerBlock\n");
+    return text.end();
+}
+
+bool_t CanRecordConverter::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( log_ == NULLPTR )
+        {
+            break;
+        }
+        if( format_ == FORMAT_CANDUMP )
+        {
+            pos_ = 0;
+            res = true;
+            break;
+        }
+        if( format_ != FORMAT_BINARY )
+        {
+            break;
+        }
+        if( size_ < static_cast<size_t>(CanRecorder::LOG_HEADER_SIZE) )
+        {
+            break;
+        }
+        uint8_t header[CanRecorder::LOG_HEADER_SIZE];
+        CanRecorder::encodeHeader(header);
+        bool_t isHeader( true );
+        for(int32_t i(0); i<CanRecorder::LOG_HEADER_SIZE; i++)
+        {
+            if( log_[i] != header[i] )
+            {
+                isHeader = false;
+                break;
+            }
+        }
+        if( !isHeader )
+        {
+            break;
+        }
+        pos_ = CanRecorder::LOG_HEADER_SIZE;
+        res = true;
+    } while(false);
+    return res;
+}
+
+int32_t CanRecordConverter::parseHex(char_t const* str, size_t size, size_t* pos, int32_t digits, uint32_t* value)
+{
+    int32_t count( 0 );
+    uint32_t result( 0 );
+    while( count < digits && *pos < size )
+    {
+        char_t const ch( str[*pos] );
+        uint32_t digit( 0 );
+        if( ch >= '0' && ch <= '9' )
+        {
+            digit = static_cast<uint32_t>(ch - '0');
+        }
+        else if( ch >= 'A' && ch <= 'F' )
+        {
+            digit = static_cast<uint32_t>(ch - 'A' + 10);
+        }
+        else if( ch >= 'a' && ch <= 'f' )
+        {
+            digit = static_cast<uint32_t>(ch - 'a' + 10);
+        }
+        else
+        {
+            break;
+        }
+        result = (result << 4) | digit;
+        (*pos)++;
+        count++;
+    }
+    *value = result;
+    return count;
+}
+
+int32_t CanRecordConverter::parseDec(char_t const* str, size_t size, size_t* pos, uint64_t* value)
+{
+    int32_t count( 0 );
+    uint64_t result( 0 );
+    while( *pos < size && str[*pos] >= '0' && str[*pos] <= '9' && count < 19 )
+    {
+        result = result * 10 + static_cast<uint64_t>(str[*pos] - '0');
+        (*pos)++;
+        count++;
+    }
+    *value = result;
+    return count;
+}
+
+CanRecordConverter::Text::Text(char_t* str, int32_t size)
+    : str_( str )
+    , size_( (str != NULLPTR) ? size : 0 )
+    , len_( 0 ) {
+}
+
+void CanRecordConverter::Text::put(char_t const* str)
+{
+    while( *str != '\0' )
+    {
+        put(*str++);
+    }
+}
+
+void CanRecordConverter::Text::put(char_t ch)
+{
+    if( len_ < size_ )
+    {
+        str_[len_] = ch;
+    }
+    len_++;
+}
+
+void CanRecordConverter::Text::putHex(uint32_t value, int32_t digits)
+{
+    char_t const* const HEX( "0123456789ABCDEF" );
+    int32_t count( 8 );
+    while( count > digits && ((value >> ((count - 1) * 4)) & 0xF) == 0 )
+    {
+        count--;
+    }
+    for(int32_t i(count - 1); i>=0; i--)
+    {
+        put( HEX[(value >> (i * 4)) & 0xF] );
+    }
+}
+
+void CanRecordConverter::Text::putDec(uint64_t value, int32_t digits, char_t fill)
+{
+    char_t buffer[20];
+    int32_t count( 0 );
+    do
+    {
+        buffer[count++] = static_cast<char_t>( '0' + static_cast<int32_t>(value % 10) );
+        value /= 10;
+    } while( value != 0 && count < 20 );
+    for(int32_t i(count); i<digits; i++)
+    {
+        put(fill);
+    }
+    while( count > 0 )
+    {
+        put( buffer[--count] );
+    }
+}
+
+int32_t CanRecordConverter::Text::end()
+{
+    int32_t res( -1 );
+    if( len_ < size_ )
+    {
+        str_[len_] = '\0';
+        res = len_;
+    }
+    else if( size_ > 0 )
+    {
+        str_[size_ - 1] = '\0';
+    }
+    else
+    {
+        res = -1;
+    }
+    return res;
+}
+
+} // namespace drv
+} // namespace eoos
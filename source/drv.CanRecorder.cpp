@@ -0,0 +1,191 @@
+/**
+ * @file      drv.CanRecorder.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanRecorder.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanRecorder::CanRecorder(uint8_t* buffer, size_t size, CanTimebase& timebase)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , buffer_( buffer )
+    , size_( size )
+    , head_( 0 )
+    , tail_( 0 )
+    , timebase_( timebase )
+    , time_( 0 )
+    , lost_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanRecorder::~CanRecorder()
+{
+}
+
+bool_t CanRecorder::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanRecorder::record(Can::Frame const& frame, Source source)
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        uint32_t const time( timebase_.getTime() );
+        uint8_t record[MAXIMUM_RECORD_SIZE];
+        int32_t const size( encode(frame, source, time - time_, record) );
+        res = write(record, static_cast<size_t>(size));
+        if( res )
+        {
+            time_ = time;
+        }
+        else
+        {
+            lost_++;
+        }
+    }
+    return res;
+}
+
+size_t CanRecorder::read(uint8_t* buffer, size_t size)
+{
+    size_t count( 0 );
+    if( isConstructed() && buffer != NULLPTR )
+    {
+        size_t const head( head_ );
+        size_t tail( tail_ );
+        while( count < size && tail != head )
+        {
+            buffer[count++] = buffer_[tail++];
+            if( tail == size_ )
+            {
+                tail = 0;
+            }
+        }
+        tail_ = tail;
+    }
+    return count;
+}
+
+uint32_t CanRecorder::getLost() const
+{
+    return lost_;
+}
+
+int32_t CanRecorder::encode(Can::Frame const& frame, Source source, uint32_t delta, uint8_t* buffer)
+{
+    int32_t index( 0 );
+    bool_t const isRtr( (frame.ir & Can::Frame::IR_RTR_MASK) != 0 );
+    bool_t const isIde( (frame.ir & Can::Frame::IR_IDE_MASK) != 0 );
+    uint32_t dlc( frame.dtr & Can::Frame::DTR_DLC_MASK );
+    dlc = (dlc > 8) ? 8 : dlc;
+    uint8_t head( static_cast<uint8_t>(dlc) );
+    head |= (isRtr) ? 0x10 : 0x00;
+    head |= (isIde) ? 0x20 : 0x00;
+    head |= static_cast<uint8_t>( (static_cast<uint32_t>(source) & 0x3) << 6 );
+    buffer[index++] = head;
+    // Time delta in unsigned LEB128
+    do
+    {
+        uint8_t byte( static_cast<uint8_t>(delta & 0x7F) );
+        delta >>= 7;
+        if( delta != 0 )
+        {
+            byte |= 0x80;
+        }
+        buffer[index++] = byte;
+    } while( delta != 0 );
+    // Identifier
+    if( isIde )
+    {
+        uint32_t const id( frame.ir >> Can::Frame::IR_EXID_POS );
+        buffer[index++] = static_cast<uint8_t>( id       );
+        buffer[index++] = static_cast<uint8_t>( id >> 8  );
+        buffer[index++] = static_cast<uint8_t>( id >> 16 );
+        buffer[index++] = static_cast<uint8_t>( id >> 24 );
+    }
+    else
+    {
+        uint32_t const id( frame.ir >> Can::Frame::IR_STID_POS );
+        buffer[index++] = static_cast<uint8_t>( id       );
+        buffer[index++] = static_cast<uint8_t>( id >> 8  );
+    }
+    // Data
+    if( !isRtr )
+    {
+        for(uint32_t i(0); i<dlc; i++)
+        {
+            buffer[index++] = frame.data.v8[i];
+        }
+    }
+    return index;
+}
+
+void CanRecorder::encodeHeader(uint8_t* buffer)
+{
+    buffer[0] = 0x45; // E
+    buffer[1] = 0x43; // C
+    buffer[2] = 0x4C; // L
+    buffer[3] = 0x01; // Version
+}
+
+bool_t CanRecorder::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( buffer_ == NULLPTR )
+        {
+            break;
+        }
+        if( size_ <= static_cast<size_t>(MAXIMUM_RECORD_SIZE) )
+        {
+            break;
+        }
+        uint8_t header[LOG_HEADER_SIZE];
+        encodeHeader(header);
+        if( !write(header, sizeof(header)) )
+        {
+            break;
+        }
+        time_ = timebase_.getTime();
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanRecorder::write(uint8_t const* data, size_t size)
+{
+    bool_t res( false );
+    size_t head( head_ );
+    size_t const tail( tail_ );
+    size_t const used( (head >= tail) ? (head - tail) : (size_ - tail + head) );
+    // One byte is kept free to distinguish full buffer from empty one
+    if( size_ - used - 1 >= size )
+    {
+        for(size_t i(0); i<size; i++)
+        {
+            buffer_[head++] = data[i];
+            if( head == size_ )
+            {
+                head = 0;
+            }
+        }
+        head_ = head;
+        res = true;
+    }
+    return res;
+}
+
+} // namespace drv
+} // namespace eoos
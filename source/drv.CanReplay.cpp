@@ -0,0 +1,185 @@
+/**
+ * @file      drv.CanReplay.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanReplay.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanReplay::CanReplay(Can& can, CanRecordConverter& log, CanTimebase& timebase)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , can_( can )
+    , log_( log )
+    , timebase_( timebase )
+    , timing_( TIMING_ORIGINAL )
+    , speed_( 100 )
+    , record_()
+    , isPending_( false )
+    , isEnd_( false )
+    , isStarted_( false )
+    , origin_( 0 )
+    , elapsed_( 0 )
+    , time_( 0 )
+    , injected_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanReplay::~CanReplay()
+{
+}
+
+bool_t CanReplay::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanReplay::setTiming(Timing timing, int32_t speed)
+{
+    bool_t res( false );
+    if( isConstructed() && speed > 0 )
+    {
+        timing_ = timing;
+        speed_ = speed;
+        res = true;
+    }
+    return res;
+}
+
+int32_t CanReplay::process()
+{
+    int32_t count( 0 );
+    if( isConstructed() )
+    {
+        updateTime();
+        while( fetch() )
+        {
+            if( timing_ != TIMING_MAXIMUM && getPendingTime() > elapsed_ )
+            {
+                break;
+            }
+            Can::RxFifo const fifo( (record_.source == CanRecorder::SOURCE_RXFIFO_1) ? Can::RXFIFO_1 : Can::RXFIFO_0 );
+            if( !can_.inject(record_.message, fifo) )
+            {
+                // RX FIFO or its consumer lane is full, so try the message again on next call
+                break;
+            }
+            isPending_ = false;
+            injected_++;
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t CanReplay::getDelay()
+{
+    uint32_t delay( 0 );
+    if( isConstructed() && timing_ != TIMING_MAXIMUM )
+    {
+        updateTime();
+        if( fetch() )
+        {
+            uint64_t const time( getPendingTime() );
+            if( time > elapsed_ )
+            {
+                uint64_t const diff( time - elapsed_ );
+                delay = (diff > 0xFFFFFFFF) ? 0xFFFFFFFF : static_cast<uint32_t>(diff);
+            }
+        }
+    }
+    return delay;
+}
+
+bool_t CanReplay::isEnd() const
+{
+    return isEnd_;
+}
+
+uint32_t CanReplay::getInjected() const
+{
+    return injected_;
+}
+
+void CanReplay::restart()
+{
+    log_.rewind();
+    isPending_ = false;
+    isEnd_ = false;
+    isStarted_ = false;
+    elapsed_ = 0;
+    injected_ = 0;
+}
+
+bool_t CanReplay::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !can_.isConstructed() )
+        {
+            break;
+        }
+        if( !log_.isConstructed() )
+        {
+            break;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanReplay::fetch()
+{
+    while( !isPending_ && !isEnd_ )
+    {
+        if( !log_.read(&record_) )
+        {
+            isEnd_ = true;
+            break;
+        }
+        if( record_.source == CanRecorder::SOURCE_TX )
+        {
+            continue;
+        }
+        if( injected_ == 0 )
+        {
+            origin_ = record_.time;
+        }
+        isPending_ = true;
+    }
+    return isPending_;
+}
+
+void CanReplay::updateTime()
+{
+    uint32_t const time( timebase_.getTime() );
+    if( !isStarted_ )
+    {
+        isStarted_ = true;
+        time_ = time;
+    }
+    elapsed_ += static_cast<uint64_t>(time - time_);
+    time_ = time;
+}
+
+uint64_t CanReplay::getPendingTime() const
+{
+    uint64_t time( (record_.time > origin_) ? (record_.time - origin_) : 0 );
+    if( timing_ == TIMING_SCALED )
+    {
+        time = time * 100 / static_cast<uint64_t>(speed_);
+    }
+    return time;
+}
+
+} // namespace drv
+} // namespace eoos
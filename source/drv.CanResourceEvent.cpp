@@ -0,0 +1,117 @@
+/**
+ * @file      drv.CanResourceEvent.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanResourceEvent.hpp"
+#include "sys.Thread.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanResourceEvent::CanResourceEvent()
+    : lib::NonCopyable<lib::NoAllocator>()
+    , sem_( 0, 1 )
+    , armed_( 0 )
+    , latched_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanResourceEvent::~CanResourceEvent()
+{
+}
+
+bool_t CanResourceEvent::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+void CanResourceEvent::arm(uint32_t events)
+{
+    armed_ = events;
+    // Arm before the events are tested as an event signaled after the test has to wake up
+    __sync_synchronize();
+}
+
+void CanResourceEvent::disarm()
+{
+    armed_ = 0;
+}
+
+bool_t CanResourceEvent::wait()
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        res = sem_.acquire();
+    }
+    return res;
+}
+
+void CanResourceEvent::signal(uint32_t events)
+{
+    if( trigger(events) )
+    {
+        sem_.release();
+    }
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceEvent::signalFromInterrupt(uint32_t events)
+{
+    if( trigger(events) )
+    {
+        if( sem_.releaseFromInterrupt() )
+        {
+            if( sem_.hasToSwitchContex() )
+            {
+                sys::Thread::yieldFromInterrupt();
+            }
+        }
+    }
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceEvent::latchFromInterrupt(uint32_t events)
+{
+    static_cast<void>( __sync_fetch_and_or(&latched_, events) );
+    signalFromInterrupt(events);
+}
+
+uint32_t CanResourceEvent::take(uint32_t events)
+{
+    return __sync_fetch_and_and(&latched_, ~events) & events;
+}
+
+bool_t CanResourceEvent::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !sem_.isConstructed() )
+        {
+            break;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceEvent::trigger(uint32_t events)
+{
+    bool_t res( false );
+    uint32_t const armed( armed_ );
+    if( (armed & events) != 0 )
+    {
+        res = __sync_bool_compare_and_swap(&armed_, armed, 0);
+    }
+    return res;
+}
+
+} // namespace drv
+} // namespace eoos
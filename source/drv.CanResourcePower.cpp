@@ -0,0 +1,251 @@
+/**
+ * @file      drv.CanResourcePower.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanResourcePower.hpp"
+#include "lib.Register.hpp"
+#include "lib.Guard.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanResourcePower::CanResourcePower(CanDescriptor const& descriptor, cpu::reg::Can* reg, cpu::reg::Rcc* rcc, Can::Config const& config)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , descriptor_( descriptor )
+    , reg_( reg )
+    , rcc_( rcc )
+    , timebase_( config.timebase )
+    , idleTimeout_( config.idleTimeout )
+    , mutex_()
+    , isSleep_( false )
+    , isMeasuring_( false )
+    , wakeUpTime_( 0 )
+    , latency_( 0 )
+    , isGated_( false )
+    , isIdle_( false )
+    , idleTime_( 0 )
+    , gateTime_( 0 )
+    , gatedTime_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanResourcePower::~CanResourcePower()
+{
+}
+
+bool_t CanResourcePower::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanResourcePower::sleep()
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        lib::Guard<> const guard(mutex_);
+        if( !isSleep_ )
+        {
+            isSleep_ = true;
+            isMeasuring_ = false;
+            lib::Register<cpu::reg::Can::Mcr> mcr( reg_->mcr );
+            mcr.fetch().bit().sleep = 1;
+            mcr.commit();
+        }
+        res = true;
+    }
+    return res;
+}
+
+bool_t CanResourcePower::wakeUp()
+{
+    bool_t res( false );
+    if( isConstructed() )
+    {
+        // The guard is taken only for the sleep mode to keep transmission lock-free
+        if( isSleep_ || isGated_ )
+        {
+            lib::Guard<> const guard(mutex_);
+            ungate();
+            if( isSleep_ )
+            {
+                resume();
+            }
+        }
+        res = true;
+    }
+    return res;
+}
+
+bool_t CanResourcePower::isSleeping() const
+{
+    bool_t res( false );
+    if( isGated_ )
+    {
+        res = true;
+    }
+    else if( isConstructed() )
+    {
+        lib::Register<cpu::reg::Can::Msr> const msr( reg_->msr );
+        res = ( msr.bit().slak == 1 ) ? true : false;
+    }
+    return res;
+}
+
+uint32_t CanResourcePower::getWakeUpLatency() const
+{
+    return latency_;
+}
+
+bool_t CanResourcePower::idle()
+{
+    bool_t res( false );
+    // Give up if a wake-up request is in progress
+    if( isConstructed() && mutex_.tryLock() )
+    {
+        if( !isGated_ )
+        {
+            if( !isIdle() )
+            {
+                isIdle_ = false;
+            }
+            else if( !isIdle_ )
+            {
+                isIdle_ = true;
+                idleTime_ = timebase_->getTime();
+            }
+            else if( timebase_->getTime() - idleTime_ >= idleTimeout_ )
+            {
+                gate();
+            }
+            else
+            {
+                // Wait for the idle timeout
+            }
+        }
+        res = isGated_;
+        mutex_.unlock();
+    }
+    return res;
+}
+
+uint64_t CanResourcePower::getGatedTime()
+{
+    uint64_t time( 0 );
+    if( isConstructed() )
+    {
+        lib::Guard<> const guard(mutex_);
+        time = gatedTime_;
+        if( isGated_ )
+        {
+            time += timebase_->getTime() - gateTime_;
+        }
+    }
+    return time;
+}
+
+void CanResourcePower::handleInterrupt()
+{
+    lib::Register<cpu::reg::Can::Msr> const msr( reg_->msr );
+    if( msr.bit().wkui == 1 )
+    {
+        // Clear the flag by writing one, and resume as SOF is detected on the bus
+        reg_->msr.value = MSR_WKUI_MASK;
+        if( isSleep_ )
+        {
+            resume();
+        }
+    }
+    if( msr.bit().slaki == 1 )
+    {
+        reg_->msr.value = MSR_SLAKI_MASK;
+    }
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourcePower::handleFrame()
+{
+    if( isMeasuring_ )
+    {
+        isMeasuring_ = false;
+        latency_ = timebase_->getTime() - wakeUpTime_;
+    }
+}
+
+bool_t CanResourcePower::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( reg_ == NULLPTR || rcc_ == NULLPTR )
+        {
+            break;
+        }
+        if( !mutex_.isConstructed() )
+        {
+            break;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+void CanResourcePower::resume()
+{
+    isSleep_ = false;
+    if( timebase_ != NULLPTR )
+    {
+        wakeUpTime_ = timebase_->getTime();
+        isMeasuring_ = true;
+    }
+    // Not needed if AWUM is set as the hardware has cleared the bit, but harmless
+    lib::Register<cpu::reg::Can::Mcr> mcr( reg_->mcr );
+    mcr.fetch().bit().sleep = 0;
+    mcr.commit();
+}
+
+bool_t CanResourcePower::isIdle()
+{
+    bool_t res( false );
+    if( timebase_ != NULLPTR && idleTimeout_ != 0 && isSleep_ )
+    {
+        lib::Register<cpu::reg::Can::Msr> const msr( reg_->msr );
+        lib::Register<cpu::reg::Can::Tsr> const tsr( reg_->tsr );
+        if( msr.bit().slak == 1
+         && tsr.bit().tme0 == 1
+         && tsr.bit().tme1 == 1
+         && tsr.bit().tme2 == 1 )
+        {
+            res = true;
+        }
+    }
+    return res;
+}
+
+void CanResourcePower::gate()
+{
+    gateTime_ = timebase_->getTime();
+    isGated_ = true;
+    isIdle_ = false;
+    rcc_->apb1enr.value &= ~descriptor_.clock;
+}
+
+void CanResourcePower::ungate()
+{
+    if( isGated_ )
+    {
+        rcc_->apb1enr.value |= descriptor_.clock;
+        gatedTime_ += timebase_->getTime() - gateTime_;
+        isGated_ = false;
+    }
+}
+
+} // namespace drv
+} // namespace eoos
@@ -4,19 +4,27 @@
  * @copyright 2023-2024, Sergey Baigudin, Baigudin Software
  */
 #include "drv.CanResourceRx.hpp"
-#include "lib.Register.hpp"
+#include "drv.CanRegister.hpp"
 
 namespace eoos
 {
 namespace drv
 {
 
-CanResourceRx::CanResourceRx(Can::Config const& config, cpu::reg::Can* reg, api::Supervisor& svc)
+CanResourceRx::CanResourceRx(Can::Config const& config, CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event)
     : lib::NonCopyable<lib::NoAllocator>()
     , reg_( reg )
     , mutex_()
-    , fifo0_( Can::RXFIFO_0, ((config.reg.mcr.rflm == 1) ? true : false), reg, svc )
-    , fifo1_( Can::RXFIFO_1, ((config.reg.mcr.rflm == 1) ? true : false), reg, svc ) {
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER == 1
+    , worker_( config.workerPriority )
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+    , fifo0_( Can::RXFIFO_0, ((config.reg.mcr.rflm == 1) ? true : false), descriptor, reg, svc, power, event )
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    , fifo1_( Can::RXFIFO_1, ((config.reg.mcr.rflm == 1) ? true : false), descriptor, reg, svc, power, event )
+    #endif
+    {
     bool_t const isConstructed( construct() );
     setConstructed( isConstructed );
 }    
@@ -33,74 +41,97 @@ bool_t CanResourceRx::isConstructed() const
 bool_t CanResourceRx::receive(Can::Message* message, Can::RxFifo fifo)
 {
     bool_t res( false );
-    switch(fifo)
+    Can::Frame frame;
+    if( message != NULLPTR && receive(&frame, fifo) )
     {
-        case Can::RXFIFO_0:
-        {
-            res = fifo0_.receive(message);
-            break;
-        }
-        case Can::RXFIFO_1:
-        {
-            res = fifo1_.receive(message);
-            break;
-        }
-        default:
-        {
-            res = false;
-            break;
-        }
+        frame.unpack(message);
+        res = true;
     }
-	return res;
+    return res;
+}
+
+bool_t CanResourceRx::receive(Can::Frame* frame, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        res = rxFifo->receive(frame);
+    }
+    return res;
+}
+
+bool_t CanResourceRx::receive(Can::Frame* frame, Can::RxFifo fifo, int32_t consumer)
+{
+    bool_t res( false );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        res = rxFifo->receive(frame, consumer);
+    }
+    return res;
+}
+
+bool_t CanResourceRx::cancel(Can::RxFifo fifo)
+{
+    bool_t res( false );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        res = rxFifo->cancel();
+    }
+    return res;
+}
+
+bool_t CanResourceRx::setConsumers(Can::RxFifo fifo, int32_t number)
+{
+    bool_t res( false );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        res = rxFifo->setConsumers(number);
+    }
+    return res;
+}
+
+int32_t CanResourceRx::getLaneDropCounter(Can::RxFifo fifo)
+{
+    int32_t res( -1 );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        res = rxFifo->getLaneDropCounter();
+    }
+    return res;
+}
+
+bool_t CanResourceRx::receiveAsync(Can::Request* request, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        res = rxFifo->receiveAsync(request);
+    }
+    return res;
 }
 
 bool_t CanResourceRx::setReceiveFilter(Can::RxFilter const& filter)
 {
     bool_t res( false );
-    if( isConstructed() && ( filter.index < Can::RxFilter::NUMBER_OF_FILTER_GROUPS ) )
+    if( isConstructed() && ( filter.index < Can::RxFilter::NUMBER_OF_FILTER_GROUPS ) && ( getFifo(static_cast<Can::RxFifo>(filter.fifo)) != NULLPTR ) )
     {
         lib::Guard<> const guard(mutex_);
-        lib::Register<cpu::reg::Can::Fmr>   fmr  ( reg_->fmr   );
-        lib::Register<cpu::reg::Can::Fm1r>  fm1r ( reg_->fm1r  );        
-        lib::Register<cpu::reg::Can::Fs1r>  fs1r ( reg_->fs1r  );
-        lib::Register<cpu::reg::Can::Ffa1r> ffa1r( reg_->ffa1r );
-        lib::Register<cpu::reg::Can::Fa1r>  fa1r ( reg_->fa1r  );
         // Set initialization mode for the filters
-        fmr.bit().finit = 1;
-        fmr.commit();
+        CanRegister::modify<CanRegister::Fmr::Finit>( reg_->fmr, CanRegister::Fmr::Finit::MASK );
         // Deactivate filter
-        fa1r.clearBit( filter.index );
-        fa1r.commit();
+        CanRegister::assign( reg_->fa1r, filter.index, false );
         // Set filter mode
-        if( filter.mode == Can::RxFilter::MODE_IDMASK )
-        {
-            fm1r.clearBit( filter.index );
-        }
-        if( filter.mode == Can::RxFilter::MODE_IDLIST )
-        {
-            fm1r.setBit( filter.index );
-        }
-        fm1r.commit();
+        CanRegister::assign( reg_->fm1r, filter.index, filter.mode == Can::RxFilter::MODE_IDLIST );
         // Set filter scale
-        if( filter.scale == Can::RxFilter::SCALE_16BIT )
-        {
-            fs1r.clearBit( filter.index );
-        }
-        if( filter.scale == Can::RxFilter::SCALE_32BIT )
-        {
-            fs1r.setBit( filter.index );
-        }
-        fs1r.commit();
+        CanRegister::assign( reg_->fs1r, filter.index, filter.scale == Can::RxFilter::SCALE_32BIT );
         // Set FIFO
-        if( filter.fifo == Can::RxFilter::FIFO_0 )
-        {
-            ffa1r.clearBit( filter.index );
-        }
-        if( filter.fifo == Can::RxFilter::FIFO_1 )
-        {
-            ffa1r.setBit( filter.index );
-        }
-        ffa1r.commit();
+        CanRegister::assign( reg_->ffa1r, filter.index, filter.fifo == Can::RxFilter::FIFO_1 );
         // Write filter bank
         union
         {
@@ -112,16 +143,130 @@ bool_t CanResourceRx::setReceiveFilter(Can::RxFilter const& filter)
         reg_->firx[filter.index][0].value = reg.firx[0];
         reg_->firx[filter.index][1].value = reg.firx[1];
         // Activate filter
-        fa1r.setBit( filter.index );
-        fa1r.commit();        
+        CanRegister::assign( reg_->fa1r, filter.index, true );
         // Set active filters mode
-        fmr.bit().finit = 0;
-        fmr.commit();
+        CanRegister::modify<CanRegister::Fmr::Finit>( reg_->fmr, 0 );
         res = true;
     }
     return res;
 }
 
+void CanResourceRx::setRecorder(CanRecorder* recorder)
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+    fifo0_.setRecorder(recorder);
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    fifo1_.setRecorder(recorder);
+    #endif
+}
+
+void CanResourceRx::setMonitor(CanMonitor* monitor)
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+    fifo0_.setMonitor(monitor);
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    fifo1_.setMonitor(monitor);
+    #endif
+}
+
+void CanResourceRx::setRouter(CanRouter* router)
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+    fifo0_.setRouter(router);
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    fifo1_.setRouter(router);
+    #endif
+}
+
+bool_t CanResourceRx::setHandler(Can::Handler* handler, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER == 1
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        worker_.setHandler(handler, rxFifo, fifo);
+        CanResourceRxWorker* worker( NULLPTR );
+        if( handler != NULLPTR )
+        {
+            worker = &worker_;
+        }
+        rxFifo->setWorker(worker);
+        // Pass the frames which have been received before the worker is set
+        worker_.notify();
+        res = true;
+    }
+    #else
+    static_cast<void>( handler );
+    static_cast<void>( fifo );
+    #endif
+    return res;
+}
+
+bool_t CanResourceRx::inject(Can::Message const& message, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        Can::Frame frame;
+        frame.pack(message);
+        res = rxFifo->inject(frame);
+    }
+    return res;
+}
+
+void CanResourceRx::disable()
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+    fifo0_.disable();
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    fifo1_.disable();
+    #endif
+}
+
+void CanResourceRx::enable()
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+    fifo0_.enable();
+    #endif
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+    fifo1_.enable();
+    #endif
+}
+
+uint32_t CanResourceRx::poll(uint32_t events)
+{
+    uint32_t res( 0 );
+    for(int32_t i(0); i<CanResourceRxFifo::NUMBER_OF_RX_FIFOS; i++)
+    {
+        uint32_t const event( Can::EVENT_RXFIFO_0 << i );
+        if( (events & event) == 0 )
+        {
+            continue;
+        }
+        CanResourceRxFifo* const rxFifo( getFifo(static_cast<Can::RxFifo>(i)) );
+        if( rxFifo != NULLPTR && rxFifo->isReceivable() )
+        {
+            res |= event;
+        }
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceRx::handleInterrupt(Can::RxFifo fifo)
+{
+    CanResourceRxFifo* const rxFifo( getFifo(fifo) );
+    if( rxFifo != NULLPTR )
+    {
+        rxFifo->handleInterrupt();
+    }
+}
+
 bool_t CanResourceRx::construct()
 {
     bool_t res( false );
@@ -135,18 +280,56 @@ bool_t CanResourceRx::construct()
         {
             break;
         }
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_WORKER == 1
+        if( !worker_.isConstructed() )
+        {
+            break;
+        }
+        #endif
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
         if( !fifo0_.isConstructed() )
         {
             break;
         }
+        #endif
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
         if( !fifo1_.isConstructed() )
         {
             break;
-        }                
+        }
+        #endif
         res = true;
     } while(false);
     return res;    
 }
 
+EOOS_DRV_CAN_RAMFUNC CanResourceRxFifo* CanResourceRx::getFifo(Can::RxFifo fifo)
+{
+    CanResourceRxFifo* rxFifo( NULLPTR );
+    switch(fifo)
+    {
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO0 == 1
+        case Can::RXFIFO_0:
+        {
+            rxFifo = &fifo0_;
+            break;
+        }
+        #endif
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXFIFO1 == 1
+        case Can::RXFIFO_1:
+        {
+            rxFifo = &fifo1_;
+            break;
+        }
+        #endif
+        default:
+        {
+            rxFifo = NULLPTR;
+            break;
+        }
+    }
+    return rxFifo;
+}
+
 } // namespace drv
 } // namespace eoos
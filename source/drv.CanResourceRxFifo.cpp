@@ -4,7 +4,8 @@
  * @copyright 2024, Sergey Baigudin, Baigudin Software
  */
 #include "drv.CanResourceRxFifo.hpp"
-#include "lib.Register.hpp"
+#include "drv.CanResourceRxWorker.hpp"
+#include "drv.CanRegister.hpp"
 #include "sys.Thread.hpp"
 
 namespace eoos
@@ -12,16 +13,30 @@ namespace eoos
 namespace drv
 {
 
-CanResourceRxFifo::CanResourceRxFifo(Can::RxFifo index,  bool_t isLocked, cpu::reg::Can* reg, api::Supervisor& svc)
+CanResourceRxFifo::CanResourceRxFifo(Can::RxFifo index,  bool_t isLocked, CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event)
     : lib::NonCopyable<lib::NoAllocator>()
     , api::Runnable()
     , fifo_(isLocked)
-    , mutex_()
-    , sem_(0, NUMBER_OF_RX_MAILBOXS_IN_FIFO)
+    , sem_(0, NUMBER_OF_FRAMES_IN_FIFO)
     , index_( index )
+    , descriptor_( descriptor )
     , reg_( reg )
     , svc_( svc )
-    , int_(){
+    , int_()
+    , recorder_( NULLPTR )
+    , monitor_( NULLPTR )
+    , router_( NULLPTR )
+    , worker_( NULLPTR )
+    , head_( NULLPTR )
+    , tail_( NULLPTR )
+    , reception_( RECEPTION_NONE )
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+    , numberOfLanes_( 0 )
+    , isLanesFixed_( false )
+    , laneDrops_( 0 )
+    #endif
+    , power_( power )
+    , event_( event ) {
     bool_t const isConstructed( construct() );
     setConstructed( isConstructed );
 }    
@@ -36,56 +51,300 @@ bool_t CanResourceRxFifo::isConstructed() const
     return Parent::isConstructed();
 }
 
-bool_t CanResourceRxFifo::receive(Can::Message* message)
+bool_t CanResourceRxFifo::receive(Can::Frame* frame)
 {
     bool_t res( false );
-    if( isConstructed() && sem_.acquire() )
+    if( isConstructed() && frame != NULLPTR && bind(RECEPTION_SYNC) && sem_.acquire() )
     {
-        lib::Guard<> const guard(mutex_);
-        if( !fifo_.isEmpty() )
+        res = fifo_.get(frame);
+    }
+    return res;
+}
+
+bool_t CanResourceRxFifo::receive(Can::Frame* frame, int32_t consumer)
+{
+    bool_t res( false );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+    if( isConstructed() && consumer >= 0 && consumer < Can::MAXIMUM_NUMBER_OF_CONSUMERS )
+    {
+        res = lanes_[consumer].receive(frame);
+    }
+    #else
+    static_cast<void>( frame );
+    static_cast<void>( consumer );
+    #endif
+    return res;
+}
+
+bool_t CanResourceRxFifo::cancel()
+{
+    bool_t res( false );
+    if( isConstructed() && bind(RECEPTION_SYNC) )
+    {
+        // A count with no frame makes the receive function return false
+        sem_.release();
+        res = true;
+    }
+    return res;
+}
+
+bool_t CanResourceRxFifo::setConsumers(int32_t number)
+{
+    bool_t res( false );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+    if( isConstructed() && number >= 0 && number <= Can::MAXIMUM_NUMBER_OF_CONSUMERS )
+    {
+        // Lock out the FIFO interrupt as the first frame received fixes the number
+        int_->disable();
+        if( !isLanesFixed_ )
         {
-            *message = fifo_.peek();
-            fifo_.remove();
+            numberOfLanes_ = number;
+            isLanesFixed_ = true;
             res = true;
         }
+        int_->enable();
     }
+    #else
+    static_cast<void>( number );
+    #endif
+    return res;
+}
+
+int32_t CanResourceRxFifo::getLaneDropCounter() const
+{
+    int32_t res( -1 );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+    res = laneDrops_;
+    #endif
     return res;
 }
 
-void CanResourceRxFifo::start()
+bool_t CanResourceRxFifo::receiveAsync(Can::Request* request)
 {
-    lib::Register<cpu::reg::Can::RfXr> rfxr ( reg_->rfxr[index_]     );    
-    if( rfxr.bit().fmpx > 0 )
+    bool_t res( false );
+    if( isConstructed() && request != NULLPTR && request->completion != NULLPTR && bind(RECEPTION_ASYNC) )
     {
-        lib::Register<cpu::reg::Can::Rx::RiXr>  rixr ( reg_->rx[index_].rixr  );
-        lib::Register<cpu::reg::Can::Rx::RdtXr> rdtxr( reg_->rx[index_].rdtxr );
-        lib::Register<cpu::reg::Can::Rx::RdlXr> rdlxr( reg_->rx[index_].rdlxr );    
-        lib::Register<cpu::reg::Can::Rx::RdhXr> rdhxr( reg_->rx[index_].rdhxr );
-        Can::Message message;   
-        message.id.stid = rixr.bit().stid;
-        message.id.exid = rixr.bit().exid;
-        message.rtr = (rixr.bit().rtr == 1) ? true : false;
-        message.ide = (rixr.bit().ide == 1) ? true : false;
-        message.dlc = rdtxr.bit().dlc;
-        message.data.v32[0] = rdlxr.value();
-        message.data.v32[1] = rdhxr.value();
-        bool_t isAddedToLast( !fifo_.isLocked() && fifo_.isFull() );
-        if( fifo_.add(message) )
+        request->next = NULLPTR;
+        // Lock out the FIFO interrupt as the consumer of the requests
+        int_->disable();
+        bool_t isReceived( false );
+        if( head_ == NULLPTR )
+        {
+            isReceived = fifo_.get(&request->frame);
+        }
+        if( !isReceived )
         {
-            if( !isAddedToLast )
+            if( tail_ == NULLPTR )
+            {
+                head_ = request;
+            }
+            else
             {
-                if( sem_.releaseFromInterrupt() )
-                {
-                    if( sem_.hasToSwitchContex() )
-                    {
-                        sys::Thread::yieldFromInterrupt();
-                    }
-                }
+                tail_->next = request;
             }
+            tail_ = request;
+        }
+        int_->enable();
+        if( isReceived )
+        {
+            request->isOk = true;
+            request->completion->complete(request);
         }
-        rfxr.bit().rfomx = 1;
-        rfxr.commit();
+        res = true;
     }
+    return res;
+}
+
+void CanResourceRxFifo::setRecorder(CanRecorder* recorder)
+{
+    recorder_ = recorder;
+}
+
+void CanResourceRxFifo::setMonitor(CanMonitor* monitor)
+{
+    monitor_ = monitor;
+}
+
+void CanResourceRxFifo::setRouter(CanRouter* router)
+{
+    router_ = router;
+}
+
+void CanResourceRxFifo::setWorker(CanResourceRxWorker* worker)
+{
+    worker_ = worker;
+}
+
+bool_t CanResourceRxFifo::get(Can::Frame* frame)
+{
+    return fifo_.get(frame);
+}
+
+bool_t CanResourceRxFifo::isEmpty() const
+{
+    return fifo_.isEmpty();
+}
+
+bool_t CanResourceRxFifo::isReceivable() const
+{
+    return ( worker_ == NULLPTR && !isEmpty() ) ? true : false;
+}
+
+bool_t CanResourceRxFifo::inject(Can::Frame const& frame)
+{
+    bool_t res( false );
+    if( isConstructed() && !fifo_.isFull() )
+    {
+        res = put(frame, false);
+    }
+    return res;
+}
+
+void CanResourceRxFifo::disable()
+{
+    int_->disable();
+}
+
+void CanResourceRxFifo::enable()
+{
+    int_->enable();
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceRxFifo::start()
+{
+    handleInterrupt();
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceRxFifo::handleInterrupt()
+{
+    cpu::reg::Can::RfXr volatile& rfxr( reg_->rfxr[index_] );
+    uint32_t const status( rfxr.value );
+    if( CanRegister::Rfxr::Fmp::get(status) > 0 )
+    {
+        power_.handleFrame();
+        cpu::reg::Can::Rx volatile& rx( reg_->rx[index_] );
+        Can::Frame frame;
+        frame.ir = rx.rixr.value;
+        frame.dtr = rx.rdtxr.value;
+        frame.data.v32[0] = rx.rdlxr.value;
+        frame.data.v32[1] = rx.rdhxr.value;
+        // Release the mailbox right after the raw words are copied, so the hardware FIFO
+        // gets the mailbox back before the frame is passed, and the frame is decoded by consumers.
+        // The full and overrun flags read are cleared by the same store.
+        rfxr.value = CanRegister::Rfxr::Rfom::MASK | ( status & CanRegisterMask<CanRegister::Rfxr::Full, CanRegister::Rfxr::Fovr>::MASK );
+        static_cast<void>( put(frame, true) );
+    }
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceRxFifo::put(Can::Frame const& frame, bool_t isInterrupt)
+{
+    bool_t res( true );
+    CanRecorder* const recorder( recorder_ );
+    if( recorder != NULLPTR )
+    {
+        CanRecorder::Source const source( (index_ == Can::RXFIFO_0) ? CanRecorder::SOURCE_RXFIFO_0 : CanRecorder::SOURCE_RXFIFO_1 );
+        static_cast<void>( recorder->record(frame, source) );
+    }
+    CanMonitor* const monitor( monitor_ );
+    if( monitor != NULLPTR )
+    {
+        static_cast<void>( monitor->refresh(frame) );
+    }
+    CanRouter* const router( router_ );
+    bool_t isConsumed( false );
+    if( router != NULLPTR )
+    {
+        isConsumed = router->route(frame, index_);
+    }
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+    isLanesFixed_ = true;
+    int32_t const numberOfLanes( numberOfLanes_ );
+    #endif
+    if( !isConsumed )
+    {
+        Can::Request* const request( head_ );
+        if( request != NULLPTR )
+        {
+            // Complete a waiting request directly, so the frame is not put to the SW FIFO
+            head_ = request->next;
+            if( head_ == NULLPTR )
+            {
+                tail_ = NULLPTR;
+            }
+            request->frame = frame;
+            request->isOk = true;
+            request->completion->complete(request);
+        }
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+        else if( numberOfLanes != 0 )
+        {
+            // Frames of one identifier go to one lane to keep their order
+            uint32_t const key( frame.ir & KEY_MASK );
+            uint32_t const hash( (key >> Can::Frame::IR_STID_POS) ^ (key >> Can::Frame::IR_EXID_POS) );
+            if( !lanes_[hash % static_cast<uint32_t>(numberOfLanes)].put(frame, isInterrupt) )
+            {
+                laneDrops_++;
+                res = false;
+            }
+        }
+        #endif
+        else
+        {
+            CanResourceRxQueue<NUMBER_OF_FRAMES_IN_FIFO>::Result const result( fifo_.put(frame) );
+            if( result == CanResourceRxQueue<NUMBER_OF_FRAMES_IN_FIFO>::RESULT_ADDED )
+            {
+                wake(isInterrupt);
+            }
+            else if( result == CanResourceRxQueue<NUMBER_OF_FRAMES_IN_FIFO>::RESULT_REJECTED )
+            {
+                res = false;
+            }
+            else
+            {
+                // The frame overwrote the last one, which consumer is woken up already
+            }
+        }
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceRxFifo::wake(bool_t isInterrupt)
+{
+    CanResourceRxWorker* const worker( worker_ );
+    uint32_t const event( Can::EVENT_RXFIFO_0 << index_ );
+    if( worker != NULLPTR )
+    {
+        if( isInterrupt )
+        {
+            worker->notifyFromInterrupt();
+        }
+        else
+        {
+            worker->notify();
+        }
+    }
+    else if( isInterrupt )
+    {
+        if( sem_.releaseFromInterrupt() )
+        {
+            if( sem_.hasToSwitchContex() )
+            {
+                sys::Thread::yieldFromInterrupt();
+            }
+        }
+        event_.signalFromInterrupt(event);
+    }
+    else
+    {
+        sem_.release();
+        event_.signal(event);
+    }
+}
+
+bool_t CanResourceRxFifo::bind(int32_t reception)
+{
+    int32_t const current( __sync_val_compare_and_swap(&reception_, RECEPTION_NONE, reception) );
+    return ( current == RECEPTION_NONE || current == reception ) ? true : false;
 }
 
 bool_t CanResourceRxFifo::construct()
@@ -101,14 +360,24 @@ bool_t CanResourceRxFifo::construct()
         {
             break;
         }
-        if( !mutex_.isConstructed() )
+        if( !sem_.isConstructed() )
         {
             break;
+        }        
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+        bool_t isLanes( true );
+        for(int32_t i(0); i<Can::MAXIMUM_NUMBER_OF_CONSUMERS; i++)
+        {
+            if( !lanes_[i].isConstructed() )
+            {
+                isLanes = false;
+            }
         }
-        if( !sem_.isConstructed() )
+        if( !isLanes )
         {
             break;
-        }        
+        }
+        #endif
         if( !initializeInterrupt() )
         {
             break;
@@ -124,11 +393,11 @@ bool_t CanResourceRxFifo::initializeInterrupt()
     int32_t source( EXCEPTION_WRONG );
     if(index_ == Can::RXFIFO_0)
     {
-        source = EXCEPTION_CAN1_RX0;
+        source = descriptor_.exceptionRx0;
     }
     else if(index_ == Can::RXFIFO_1)
     {
-        source = EXCEPTION_CAN1_RX1;
+        source = descriptor_.exceptionRx1;
     }
     else
     {
@@ -0,0 +1,88 @@
+/**
+ * @file      drv.CanResourceRxLane.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanResourceRxLane.hpp"
+#include "sys.Thread.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanResourceRxLane::CanResourceRxLane()
+    : lib::NonCopyable<lib::NoAllocator>()
+    , fifo_( true )
+    , sem_( 0, NUMBER_OF_FRAMES_IN_LANE ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanResourceRxLane::~CanResourceRxLane()
+{
+}
+
+bool_t CanResourceRxLane::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanResourceRxLane::receive(Can::Frame* frame)
+{
+    bool_t res( false );
+    if( isConstructed() && frame != NULLPTR && sem_.acquire() )
+    {
+        res = fifo_.get(frame);
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceRxLane::put(Can::Frame const& frame, bool_t isInterrupt)
+{
+    bool_t res( false );
+    if( fifo_.put(frame) == CanResourceRxQueue<NUMBER_OF_FRAMES_IN_LANE>::RESULT_ADDED )
+    {
+        if( isInterrupt )
+        {
+            if( sem_.releaseFromInterrupt() )
+            {
+                if( sem_.hasToSwitchContex() )
+                {
+                    sys::Thread::yieldFromInterrupt();
+                }
+            }
+        }
+        else
+        {
+            sem_.release();
+        }
+        res = true;
+    }
+    return res;
+}
+
+bool_t CanResourceRxLane::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !fifo_.isConstructed() )
+        {
+            break;
+        }
+        if( !sem_.isConstructed() )
+        {
+            break;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+} // namespace drv
+} // namespace eoos
@@ -0,0 +1,178 @@
+/**
+ * @file      drv.CanResourceRxWorker.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanResourceRxWorker.hpp"
+#include "sys.Thread.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanResourceRxWorker::CanResourceRxWorker(int32_t priority)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , api::Task()
+    , priority_( priority )
+    , sem_( 0, 1 )
+    , isIdle_( 1 )
+    , isStopped_( false )
+    , thread_( *this ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanResourceRxWorker::~CanResourceRxWorker()
+{
+    if( isConstructed() )
+    {
+        isStopped_ = true;
+        sem_.release();
+        static_cast<void>( thread_.join() );
+    }
+}
+
+bool_t CanResourceRxWorker::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+void CanResourceRxWorker::start()
+{
+    while( !isStopped_ )
+    {
+        if( !sem_.acquire() )
+        {
+            continue;
+        }
+        bool_t isDone( false );
+        while( !isDone && !isStopped_ )
+        {
+            int32_t count( drain() );
+            while( count != 0 )
+            {
+                count = drain();
+            }
+            // Go idle and test the FIFOs again as a frame put after the last drain is not notified
+            isIdle_ = 1;
+            __sync_synchronize();
+            isDone = true;
+            if( !isEmpty() && __sync_bool_compare_and_swap(&isIdle_, 1, 0) )
+            {
+                isDone = false;
+            }
+        }
+    }
+}
+
+size_t CanResourceRxWorker::getStackSize() const
+{
+    return STACK_SIZE;
+}
+
+void CanResourceRxWorker::setHandler(Can::Handler* handler, CanResourceRxFifo* fifo, Can::RxFifo index)
+{
+    fifo_[index] = fifo;
+    handler_[index] = handler;
+}
+
+void CanResourceRxWorker::notifyFromInterrupt()
+{
+    if( __sync_bool_compare_and_swap(&isIdle_, 1, 0) )
+    {
+        if( sem_.releaseFromInterrupt() )
+        {
+            if( sem_.hasToSwitchContex() )
+            {
+                sys::Thread::yieldFromInterrupt();
+            }
+        }
+    }
+}
+
+void CanResourceRxWorker::notify()
+{
+    if( __sync_bool_compare_and_swap(&isIdle_, 1, 0) )
+    {
+        sem_.release();
+    }
+}
+
+bool_t CanResourceRxWorker::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        for(int32_t i(0); i<CanResourceRxFifo::NUMBER_OF_RX_FIFOS; i++)
+        {
+            fifo_[i] = NULLPTR;
+            handler_[i] = NULLPTR;
+        }
+        if( !sem_.isConstructed() )
+        {
+            break;
+        }
+        if( !thread_.isConstructed() )
+        {
+            break;
+        }
+        if( !thread_.setPriority(priority_) )
+        {
+            break;
+        }
+        if( !thread_.execute() )
+        {
+            break;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+int32_t CanResourceRxWorker::drain()
+{
+    int32_t count( 0 );
+    for(int32_t i(0); i<CanResourceRxFifo::NUMBER_OF_RX_FIFOS; i++)
+    {
+        Can::Handler* const handler( handler_[i] );
+        CanResourceRxFifo* const fifo( fifo_[i] );
+        if( handler == NULLPTR || fifo == NULLPTR )
+        {
+            continue;
+        }
+        int32_t number( 0 );
+        while( number < MAXIMUM_NUMBER_OF_FRAMES_IN_BATCH && fifo->get(&frames_[number]) )
+        {
+            number++;
+        }
+        if( number != 0 )
+        {
+            handler->handle(frames_, number, static_cast<Can::RxFifo>(i));
+            count += number;
+        }
+    }
+    return count;
+}
+
+bool_t CanResourceRxWorker::isEmpty()
+{
+    bool_t res( true );
+    for(int32_t i(0); i<CanResourceRxFifo::NUMBER_OF_RX_FIFOS; i++)
+    {
+        CanResourceRxFifo* const fifo( fifo_[i] );
+        if( handler_[i] != NULLPTR && fifo != NULLPTR && !fifo->isEmpty() )
+        {
+            res = false;
+            break;
+        }
+    }
+    return res;
+}
+
+} // namespace drv
+} // namespace eoos
@@ -4,7 +4,7 @@
  * @copyright 2024, Sergey Baigudin, Baigudin Software
  */
 #include "drv.CanResourceStatus.hpp"
-#include "lib.Register.hpp"
+#include "drv.CanRegister.hpp"
 #include "sys.Thread.hpp"
 
 namespace eoos
@@ -12,11 +12,14 @@ namespace eoos
 namespace drv
 {
 
-CanResourceStatus::CanResourceStatus(cpu::reg::Can* reg, api::Supervisor& svc)
+CanResourceStatus::CanResourceStatus(CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event)
     : lib::NonCopyable<lib::NoAllocator>()
     , api::Runnable()
+    , descriptor_( descriptor )
     , reg_( reg )
     , svc_( svc )
+    , power_( power )
+    , event_( event )
     , int_(){
     bool_t const isConstructed( construct() );
     setConstructed( isConstructed );
@@ -32,10 +35,33 @@ bool_t CanResourceStatus::isConstructed() const
     return Parent::isConstructed();
 }
 
+void CanResourceStatus::disable()
+{
+    int_->disable();
+}
+
+void CanResourceStatus::enable()
+{
+    int_->enable();
+}
+
 void CanResourceStatus::start()
 {
-    lib::Register<cpu::reg::Can::Esr> esr( reg_->esr);
-    lib::Register<cpu::reg::Can::Msr> msr( reg_->msr);    
+    handleInterrupt();
+}
+
+void CanResourceStatus::handleInterrupt()
+{
+    uint32_t const lec( CanRegister::Esr::Lec::get(reg_->esr.value) );
+    if( lec != 0 && lec != CanRegister::Esr::LEC_BY_SOFTWARE )
+    {
+        // Mark the error code as read, so the next error sets a new one
+        reg_->esr.value = CanRegister::Esr::Lec::set(CanRegister::Esr::LEC_BY_SOFTWARE);
+    }
+    // Clear the error interrupt by writing one, otherwise the interrupt is raised again
+    reg_->msr.value = CanRegister::Msr::Erri::MASK;
+    power_.handleInterrupt();
+    event_.latchFromInterrupt(Can::EVENT_STATUS);
 }
 
 bool_t CanResourceStatus::construct()
@@ -60,7 +86,7 @@ bool_t CanResourceStatus::initializeInterrupt()
 {
     bool_t res( false );
     api::CpuInterruptController& ic( svc_.getProcessor().getInterruptController() );
-    int_.reset( ic.createResource(*this, EXCEPTION_CAN1_SCE) );
+    int_.reset( ic.createResource(*this, descriptor_.exceptionSce) );
     if( !int_.isNull() )
     {
         int_->enable();
@@ -10,17 +10,22 @@ namespace eoos
 namespace drv
 {
 
-CanResourceTx::CanResourceTx(cpu::reg::Can* reg, api::Supervisor& svc)
+CanResourceTx::CanResourceTx(CanDescriptor const& descriptor, cpu::reg::Can* reg, api::Supervisor& svc, CanResourcePower& power, CanResourceEvent& event)
     : lib::NonCopyable<lib::NoAllocator>()
+    , descriptor_( descriptor )
     , reg_( reg )  
     , svc_( svc )
-    , mutex_()
+    , power_( power )
+    , event_( event )
     , mailbox0_( 0, reg_ )
     , mailbox1_( 1, reg_ )
     , mailbox2_( 2, reg_ )
-    , mailboxSem_( NUMBER_OF_TX_MAILBOXS, NUMBER_OF_TX_MAILBOXS )    
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+    , mailboxSem_( 0, NUMBER_OF_TX_MAILBOXS )    
     , mailboxInt_( NULLPTR )
-    , mailboxIsr_( mailbox_, mailboxSem_ ) {
+    , mailboxIsr_( mailbox_, mailboxSem_, event_ )
+    #endif
+    {
     bool_t const isConstructed( construct() );
     setConstructed( isConstructed );
 }    
@@ -36,31 +41,172 @@ bool_t CanResourceTx::isConstructed() const
 }
 
 bool_t CanResourceTx::transmit(Can::Message const& message)
+{
+    Can::Frame frame;
+    frame.pack(message);
+    return transmit(frame);
+}
+
+bool_t CanResourceTx::transmit(Can::Frame const& frame)
 {
     bool_t res( false );
-    if( isConstructed() && mailboxSem_.acquire() )
+    if( isConstructed() && reserve() )
     {
-        lib::Guard<> const guard(mutex_);
-        for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
+        // A transmission request in the sleep mode is pending till wake-up
+        static_cast<void>( power_.wakeUp() );
+        res = put(frame);
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+        if( !res )
         {
-            if( mailbox_[i]->isEmpty() )
+            mailboxIsr_.unreserve();
+            mailboxSem_.release();
+        }
+        #endif
+    }
+    return res;
+}
+
+bool_t CanResourceTx::forward(Can::Frame const& frame)
+{
+    bool_t res( false );
+    if( isConstructed() && !power_.isSleeping() )
+    {
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+        // A forward does not wait, so it fails if no mailbox is free
+        if( mailboxIsr_.reserve() )
+        {
+            res = put(frame);
+            if( !res )
             {
-                res = mailbox_[i]->transmit(message);
-                break;
+                mailboxIsr_.unreserve();
             }
         }
+        #else
+        res = put(frame);
+        #endif
     }
     return res;
 }
 
+bool_t CanResourceTx::transmitAsync(Can::Request* request)
+{
+    bool_t res( false );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+    // A request is not taken in the sleep mode, as a wake-up takes the power mutex,
+    // and a completion may submit a request from an interrupt
+    if( isConstructed() && request != NULLPTR && request->completion != NULLPTR && !power_.isSleeping() )
+    {
+        // Lock out the TX interrupt as the consumer of the queued requests
+        mailboxInt_->disable();
+        mailboxIsr_.submit(request);
+        mailboxInt_->enable();
+        res = true;
+    }
+    #else
+    static_cast<void>( request );
+    #endif
+    return res;
+}
+
 int32_t CanResourceTx::getErrorCounter() const
 {
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS == 1
     int32_t errorCounter( 0 );
     for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
     {
         errorCounter += mailbox_[i]->getErrorCounter();
     }
     return errorCounter;
+    #else
+    return -1;
+    #endif
+}
+
+void CanResourceTx::setRecorder(CanRecorder* recorder)
+{
+    for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
+    {
+        mailbox_[i]->setRecorder(recorder);
+    }
+}
+
+void CanResourceTx::disable()
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+    mailboxInt_->disable();
+    #endif
+}
+
+void CanResourceTx::enable()
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+    mailboxInt_->enable();
+    #endif
+}
+
+uint32_t CanResourceTx::poll(uint32_t events)
+{
+    uint32_t res( 0 );
+    if( isConstructed() && (events & Can::EVENT_TX) != 0 )
+    {
+        for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
+        {
+            if( mailbox_[i]->isEmpty() )
+            {
+                res = Can::EVENT_TX;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceTx::handleInterrupt()
+{
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+    mailboxIsr_.handleInterrupt();
+    #endif
+}
+
+bool_t CanResourceTx::reserve()
+{
+    bool_t res( true );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+    // The semaphore is released on completions, and the reservation is tested again after each wake-up
+    res = mailboxIsr_.reserve();
+    while( !res && mailboxSem_.acquire() )
+    {
+        res = mailboxIsr_.reserve();
+    }
+    #endif
+    return res;
+}
+
+bool_t CanResourceTx::put(Can::Frame const& frame)
+{
+    bool_t res( false );
+    for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
+    {
+        CanResourceTxMailbox* const mailbox( mailbox_[i] );
+        if( !mailbox->claim() )
+        {
+            continue;
+        }
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 0
+        // Complete a previous transmission here as there is no TX interrupt
+        static_cast<void>( mailbox->routine() );
+        #endif
+        if( mailbox->isEmpty() )
+        {
+            res = mailbox->transmit(frame);
+        }
+        mailbox->release();
+        if( res )
+        {
+            break;
+        }
+    }
+    return res;
 }
 
 bool_t CanResourceTx::construct()
@@ -76,10 +222,6 @@ bool_t CanResourceTx::construct()
         {
             break;
         }
-        if( !mutex_.isConstructed() )
-        {
-            break;
-        }
         if( !mailbox0_.isConstructed() )
         {
             break;
@@ -92,6 +234,7 @@ bool_t CanResourceTx::construct()
         {
             break;
         }
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
         if( !mailboxSem_.isConstructed() )
         {
             break;            
@@ -100,6 +243,7 @@ bool_t CanResourceTx::construct()
         {
             break;
         }
+        #endif
         if( !initialize() )
         {
             break;
@@ -114,11 +258,12 @@ bool_t CanResourceTx::initialize()
     bool_t res( false );
     do 
     {
+        #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
         // Get interrupt controller
         api::CpuInterruptController& ic( svc_.getProcessor().getInterruptController() );
         // Set ISR for Transmit mailbox empty interrupt enable generated 
         // when RQCPx (Request completed mailbox) bit is set.
-        mailboxInt_.reset( ic.createResource(mailboxIsr_, EXCEPTION_CAN1_TX) );
+        mailboxInt_.reset( ic.createResource(mailboxIsr_, descriptor_.exceptionTx) );
         if( mailboxInt_.isNull() )
         {
             break;
@@ -128,6 +273,7 @@ bool_t CanResourceTx::initialize()
             break;
         }
         mailboxInt_->enable();
+        #endif
         // Complite successfully
         res = true;
     } while(false);
@@ -136,8 +282,10 @@ bool_t CanResourceTx::initialize()
 
 void CanResourceTx::deinitialize()
 {
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
     // Unset ISR for Transmit mailbox empty interrupt enable generated 
     mailboxInt_->disable();    
+    #endif
 }
 
 } // namespace drv
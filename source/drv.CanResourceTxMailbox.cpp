@@ -4,7 +4,7 @@
  * @copyright 2024, Sergey Baigudin, Baigudin Software
  */
 #include "drv.CanResourceTxMailbox.hpp"
-#include "lib.Register.hpp"
+#include "drv.CanRegister.hpp"
 
 namespace eoos
 {
@@ -16,7 +16,13 @@ CanResourceTxMailbox::CanResourceTxMailbox(int32_t index, cpu::reg::Can* reg)
     , index_( index )
     , reg_( reg )
     , requestStatus_( 0 )
-    , errorCounter_( 0 ) {  
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS == 1
+    , errorCounter_( 0 )
+    #endif
+    , recorder_( NULLPTR )
+    , request_( NULLPTR )
+    , isLoaded_( false )
+    , claim_( 0 ) {
 }    
 
 CanResourceTxMailbox::~CanResourceTxMailbox()
@@ -28,40 +34,26 @@ bool_t CanResourceTxMailbox::isConstructed() const
     return Parent::isConstructed();
 }
 
-bool_t CanResourceTxMailbox::transmit(Can::Message const& message)
+bool_t CanResourceTxMailbox::transmit(Can::Frame const& frame)
 {
     bool_t res( false );
-    if( isConstructed() && isEmpty() )
+    // A mailbox loaded is not empty till its transmission is completed by the interrupt routine
+    if( isConstructed() && !isLoaded_ && isEmpty() )
     {
-        lib::Register<cpu::reg::Can::Tx::TiXr>  tixr ( reg_->tx[index_].tixr  );
-        lib::Register<cpu::reg::Can::Tx::TdtXr> tdtxr( reg_->tx[index_].tdtxr );
-        lib::Register<cpu::reg::Can::Tx::TdlXr> tdlxr( reg_->tx[index_].tdlxr );
-        lib::Register<cpu::reg::Can::Tx::TdhXr> tdhxr( reg_->tx[index_].tdhxr );
-        tixr.fetch().bit().txrq = 0;
-        tixr.commit();
-        tixr.fetch();
-        tixr.bit().rtr = (message.rtr == true) ? 1 : 0;
-        if( message.ide == false )
-        {
-            tixr.bit().ide = 0;
-            tixr.bit().exid = 0;
-            tixr.bit().stid = message.id.stid;
-        }
-        else
-        {
-            tixr.bit().ide = 1;
-            tixr.bit().exid = message.id.exid;
-            tixr.bit().stid = message.id.stid;
-        }
-        tixr.commit();
-        tdtxr.bit().dlc = message.dlc;
-        tdtxr.commit();
-        tdlxr.value() = message.data.v32[0];
-        tdlxr.commit();
-        tdhxr.value() = message.data.v32[1];
-        tdhxr.commit();
-        tixr.fetch().bit().txrq = 1;
-        tixr.commit();
+        load(frame);
+        res = true;
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailbox::transmit(Can::Request* request)
+{
+    bool_t res( false );
+    if( isConstructed() && !isLoaded_ && isEmpty() )
+    {
+        // Set the request before the transmission as the interrupt may come right after it
+        request_ = request;
+        load(request->frame);
         res = true;
     }
     return res;
@@ -69,42 +61,36 @@ bool_t CanResourceTxMailbox::transmit(Can::Message const& message)
 
 int32_t CanResourceTxMailbox::getErrorCounter() const
 {
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS == 1
     return errorCounter_;
+    #else
+    return -1;
+    #endif
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailbox::claim()
+{
+    return __sync_bool_compare_and_swap(&claim_, 0, 1);
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailbox::release()
+{
+    __sync_synchronize();
+    claim_ = 0;
 }
 
-bool_t CanResourceTxMailbox::isEmpty()
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailbox::isEmpty()
 {
     bool_t res( false );
     if( isConstructed() )
     {
-        lib::Register<cpu::reg::Can::Tsr> tsr( reg_->tsr );
-        switch(index_)
-        {
-            case 0:
-            {
-                res = tsr.bit().tme0 == 1;
-                break;
-            }
-            case 1:
-            {
-                res = tsr.bit().tme1 == 1;
-                break;                
-            }
-            case 2:
-            {
-                res = tsr.bit().tme2 == 1;
-                break;
-            }
-            default:
-            {
-                res = false;
-            }
-        }
+        uint32_t const tme( CanRegister::Tsr::Tme::MASK << index_ );
+        res = ( (reg_->tsr.value & tme) != 0 ) ? true : false;
     }
     return res;
 }
 
-bool_t CanResourceTxMailbox::routine()
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailbox::routine()
 {
     bool_t res( false );
     if( isConstructed() )
@@ -113,59 +99,52 @@ bool_t CanResourceTxMailbox::routine()
         {
             if( isFixedRequestCompleted() )
             {
+                if( requestStatus_.bit.txok == 1 )
+                {
+                    recordFrame();
+                }
                 clearRequestStatus();
-                res = true;
+                // A completion of no load, like an abort after reset, is not counted
+                res = isLoaded_;
+                isLoaded_ = false;
+                completeRequest();
             }
         }
     }
     return res;
 }
 
-bool_t CanResourceTxMailbox::fixRequestStatus()
+void CanResourceTxMailbox::setRecorder(CanRecorder* recorder)
 {
-    bool_t res( true );
-    lib::Register<cpu::reg::Can::Tsr> const tsr( reg_->tsr );
-    switch(index_)
-    {
-        case 0:
-        {
-            requestStatus_.bit.tme  = tsr.bit().tme0 ;
-            requestStatus_.bit.terr = tsr.bit().terr0;
-            requestStatus_.bit.alst = tsr.bit().alst0;
-            requestStatus_.bit.txok = tsr.bit().txok0;
-            requestStatus_.bit.rqcp = tsr.bit().rqcp0;
-            break;
-        }
-        case 1:
-        {
-            requestStatus_.bit.tme  = tsr.bit().tme1 ;
-            requestStatus_.bit.terr = tsr.bit().terr1;
-            requestStatus_.bit.alst = tsr.bit().alst1;
-            requestStatus_.bit.txok = tsr.bit().txok1;
-            requestStatus_.bit.rqcp = tsr.bit().rqcp1;
-            break;                
-        }
-        case 2:
-        {
-            requestStatus_.bit.tme  = tsr.bit().tme2 ;
-            requestStatus_.bit.terr = tsr.bit().terr2;
-            requestStatus_.bit.alst = tsr.bit().alst2;
-            requestStatus_.bit.txok = tsr.bit().txok2;
-            requestStatus_.bit.rqcp = tsr.bit().rqcp2;
-            break;
-        }
-        default:
-        {
-            res = false;
-        }
-    }
-    return res;
+    recorder_ = recorder;
 }
 
-bool_t CanResourceTxMailbox::isFixedRequestCompleted()
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailbox::load(Can::Frame const& frame)
+{
+    // The hardware clears TXRQ when the mailbox becomes empty,
+    // so the words are copied and the request is set by the last store.
+    cpu::reg::Can::Tx volatile& tx( reg_->tx[index_] );
+    isLoaded_ = true;
+    tx.tdtxr.value = frame.dtr & CanRegister::Tdtxr::Dlc::MASK;
+    tx.tdlxr.value = frame.data.v32[0];
+    tx.tdhxr.value = frame.data.v32[1];
+    tx.tixr.value = frame.ir | CanRegister::Tixr::Txrq::MASK;
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailbox::fixRequestStatus()
+{
+    // The status of the mailbox is taken by one load of CAN_TSR
+    uint32_t const tsr( reg_->tsr.value );
+    requestStatus_.value = CanRegister::Tsr::Status::get( tsr >> (CanRegister::Tsr::MAILBOX_POS * index_) );
+    requestStatus_.bit.tme = CanRegister::Tsr::Tme::get( tsr >> index_ );
+    return true;
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailbox::isFixedRequestCompleted()
 {
-    const int32_t ERROR_COUNTER_LIMIT( 0x20000000 );
     bool_t const isTransmited( (requestStatus_.bit.rqcp == 1) && (requestStatus_.bit.tme == 1) );
+    #if EOOS_GLOBAL_DRV_CAN_ENABLE_STATISTICS == 1
+    const int32_t ERROR_COUNTER_LIMIT( 0x20000000 );
     if( isTransmited && requestStatus_.bit.txok == 0 )
     {
         if( errorCounter_ < ERROR_COUNTER_LIMIT )
@@ -173,32 +152,39 @@ bool_t CanResourceTxMailbox::isFixedRequestCompleted()
             errorCounter_++;
         }
     }    
+    #endif
     return isTransmited;
 }
 
-void CanResourceTxMailbox::clearRequestStatus()
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailbox::clearRequestStatus()
 {
-    switch(index_)
+    reg_->tsr.value = CanRegister::Tsr::Rqcp::MASK << (CanRegister::Tsr::MAILBOX_POS * index_);
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailbox::recordFrame()
+{
+    CanRecorder* const recorder( recorder_ );
+    if( recorder != NULLPTR )
     {
-        case 0:
-        {
-            reg_->tsr.value = cpu::reg::Can::Tsr::RQCP0_MASK;
-            break;
-        }
-        case 1:
-        {
-            reg_->tsr.value = cpu::reg::Can::Tsr::RQCP1_MASK;
-            break;                
-        }
-        case 2:
-        {
-            reg_->tsr.value = cpu::reg::Can::Tsr::RQCP2_MASK;
-            break;
-        }
-        default:
-        {
-            break;
-        }
+        // The mailbox registers keep the frame after its transmission
+        cpu::reg::Can::Tx volatile& tx( reg_->tx[index_] );
+        Can::Frame frame;
+        frame.ir = tx.tixr.value & ~CanRegister::Tixr::Txrq::MASK;
+        frame.dtr = tx.tdtxr.value;
+        frame.data.v32[0] = tx.tdlxr.value;
+        frame.data.v32[1] = tx.tdhxr.value;
+        static_cast<void>( recorder->record(frame, CanRecorder::SOURCE_TX) );
+    }
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailbox::completeRequest()
+{
+    Can::Request* const request( request_ );
+    if( request != NULLPTR )
+    {
+        request_ = NULLPTR;
+        request->isOk = ( requestStatus_.bit.txok == 1 ) ? true : false;
+        request->completion->complete(request);
     }
 }
 
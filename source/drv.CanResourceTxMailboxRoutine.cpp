@@ -11,11 +11,15 @@ namespace eoos
 namespace drv
 {
 
-CanResourceTxMailboxRoutine::CanResourceTxMailboxRoutine(CanResourceTxMailbox** mailbox, sys::Semaphore& mailboxSem)
+CanResourceTxMailboxRoutine::CanResourceTxMailboxRoutine(CanResourceTxMailbox** mailbox, sys::Semaphore& mailboxSem, CanResourceEvent& event)
     : lib::NonCopyable<lib::NoAllocator>()
     , api::Runnable()
     , mailbox_( mailbox )
-    , mailboxSem_( mailboxSem ) {
+    , mailboxSem_( mailboxSem )
+    , event_( event )
+    , head_( NULLPTR )
+    , tail_( NULLPTR )
+    , free_( NUMBER_OF_TX_MAILBOXS ) {
     bool_t const isConstructed( construct() );
     setConstructed( isConstructed );
 }    
@@ -29,23 +33,77 @@ bool_t CanResourceTxMailboxRoutine::isConstructed() const
     return Parent::isConstructed();
 }
 
-void CanResourceTxMailboxRoutine::start()
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailboxRoutine::start()
+{
+    handleInterrupt();
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailboxRoutine::handleInterrupt()
 {    
-    bool_t hasToSwitchContex( false );
+    int32_t completed( 0 );
     for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
     {
         if( mailbox_[i]->routine() )
+        {
+            static_cast<void>( __sync_fetch_and_add(&free_, 1) );
+            completed++;
+        }
+    }
+    if( completed != 0 )
+    {
+        // The queued requests take the mailboxes completed first, and waiting tasks are woken up
+        // to test the reservations left, so a wake-up may find no mailbox
+        drain();
+        bool_t hasToSwitchContex( false );
+        for(int32_t i(0); i<completed; i++)
         {
             if( mailboxSem_.releaseFromInterrupt() )
             {
                 hasToSwitchContex = mailboxSem_.hasToSwitchContex() || hasToSwitchContex;
-            }        
+            }
         }
+        if( hasToSwitchContex )
+        {
+            sys::Thread::yieldFromInterrupt();
+        }
+        event_.signalFromInterrupt(Can::EVENT_TX);
+    }
+}
+
+void CanResourceTxMailboxRoutine::submit(Can::Request* request)
+{
+    request->next = NULLPTR;
+    if( tail_ == NULLPTR )
+    {
+        head_ = request;
     }
-    if( hasToSwitchContex )
+    else
     {
-        sys::Thread::yieldFromInterrupt();
+        tail_->next = request;
     }
+    tail_ = request;
+    drain();
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailboxRoutine::reserve()
+{
+    bool_t res( false );
+    int32_t free( free_ );
+    while( free > 0 )
+    {
+        if( __sync_bool_compare_and_swap(&free_, free, free - 1) )
+        {
+            res = true;
+            break;
+        }
+        free = free_;
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailboxRoutine::unreserve()
+{
+    static_cast<void>( __sync_fetch_and_add(&free_, 1) );
 }
 
 bool_t CanResourceTxMailboxRoutine::construct()
@@ -62,5 +120,51 @@ bool_t CanResourceTxMailboxRoutine::construct()
     return res;    
 }
 
+EOOS_DRV_CAN_RAMFUNC void CanResourceTxMailboxRoutine::drain()
+{
+    Can::Request* request( head_ );
+    while( request != NULLPTR && reserve() )
+    {
+        // A reservation guarantees an empty mailbox, which may be claimed by other caller for a moment only
+        Can::Request* const next( request->next );
+        if( !load(request) )
+        {
+            unreserve();
+            break;
+        }
+        request = next;
+        head_ = request;
+        if( request == NULLPTR )
+        {
+            tail_ = NULLPTR;
+        }
+    }
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailboxRoutine::load(Can::Request* request)
+{
+    bool_t res( false );
+    for(int32_t i(0); i<NUMBER_OF_TX_MAILBOXS; i++)
+    {
+        res = put(mailbox_[i], request);
+        if( res )
+        {
+            break;
+        }
+    }
+    return res;
+}
+
+EOOS_DRV_CAN_RAMFUNC bool_t CanResourceTxMailboxRoutine::put(CanResourceTxMailbox* mailbox, Can::Request* request)
+{
+    bool_t res( false );
+    if( mailbox->claim() )
+    {
+        res = mailbox->transmit(request);
+        mailbox->release();
+    }
+    return res;
+}
+
 } // namespace drv
 } // namespace eoos
@@ -0,0 +1,227 @@
+/**
+ * @file      drv.CanRouter.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanRouter.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanRouter::CanRouter()
+    : lib::NonCopyable<lib::NoAllocator>()
+    , count_( 0 )
+    , forwarded_( 0 )
+    , dropped_( 0 ) {
+    bool_t const isConstructed( construct() );
+    setConstructed( isConstructed );
+}
+
+CanRouter::~CanRouter()
+{
+}
+
+bool_t CanRouter::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+bool_t CanRouter::setRoute(uint32_t id, bool_t isExtended, Route const& route)
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() || count_ >= MAXIMUM_NUMBER_OF_ROUTES )
+        {
+            break;
+        }
+        if( !isCorrect(route) )
+        {
+            break;
+        }
+        uint32_t const key( toIr(id, isExtended) & KEY_MASK );
+        uint32_t const bucket( hash(key) );
+        bool_t isSet( false );
+        for(int32_t i( buckets_[bucket] ); i != NONE; i = routes_[i].chain)
+        {
+            if( routes_[i].key == key )
+            {
+                isSet = true;
+                break;
+            }
+        }
+        if( isSet )
+        {
+            break;
+        }
+        Entry& entry( routes_[count_] );
+        prepare(route, &entry);
+        entry.can = route.can;
+        entry.target = route.target;
+        entry.key = key;
+        entry.chain = buckets_[bucket];
+        // Publish the route to the interrupts after it is completed
+        __sync_synchronize();
+        buckets_[bucket] = count_;
+        count_++;
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanRouter::setRoute(Can::RxFifo fifo, uint32_t index, Route const& route)
+{
+    bool_t res( false );
+    if( isConstructed() && fifo >= 0 && fifo < NUMBER_OF_FIFOS && index < NUMBER_OF_FILTER_INDEXES && isCorrect(route) )
+    {
+        Entry& entry( filters_[fifo][index] );
+        // Unpublish the route before it is changed
+        entry.can = NULLPTR;
+        entry.target = NULLPTR;
+        __sync_synchronize();
+        prepare(route, &entry);
+        // Publish the route to the interrupts after it is completed
+        __sync_synchronize();
+        entry.target = route.target;
+        entry.can = route.can;
+        res = true;
+    }
+    return res;
+}
+
+bool_t CanRouter::route(Can::Frame const& frame, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    Entry const* entry( NULLPTR );
+    uint32_t const index( (frame.dtr & Can::Frame::DTR_FMI_MASK) >> Can::Frame::DTR_FMI_POS );
+    if( fifo >= 0 && fifo < NUMBER_OF_FIFOS && index < NUMBER_OF_FILTER_INDEXES
+     && (filters_[fifo][index].can != NULLPTR || filters_[fifo][index].target != NULLPTR) )
+    {
+        entry = &filters_[fifo][index];
+    }
+    else
+    {
+        uint32_t const key( frame.ir & KEY_MASK );
+        for(int32_t i( buckets_[hash(key)] ); i != NONE; i = routes_[i].chain)
+        {
+            if( routes_[i].key == key )
+            {
+                entry = &routes_[i];
+                break;
+            }
+        }
+    }
+    if( entry != NULLPTR )
+    {
+        apply(*entry, frame);
+        res = entry->isConsumed;
+    }
+    return res;
+}
+
+uint32_t CanRouter::getForwarded() const
+{
+    return forwarded_;
+}
+
+uint32_t CanRouter::getDropped() const
+{
+    return dropped_;
+}
+
+bool_t CanRouter::construct()
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        for(uint32_t i(0); i<NUMBER_OF_BUCKETS; i++)
+        {
+            buckets_[i] = NONE;
+        }
+        for(int32_t i(0); i<NUMBER_OF_FIFOS; i++)
+        {
+            for(uint32_t j(0); j<NUMBER_OF_FILTER_INDEXES; j++)
+            {
+                filters_[i][j].can = NULLPTR;
+                filters_[i][j].target = NULLPTR;
+            }
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanRouter::isCorrect(Route const& route)
+{
+    return ( (route.can != NULLPTR) != (route.target != NULLPTR) ) ? true : false;
+}
+
+void CanRouter::prepare(Route const& route, Entry* entry)
+{
+    entry->isConsumed = route.isConsumed;
+    entry->irMask = KEY_MASK | Can::Frame::IR_RTR_MASK;
+    entry->irValue = 0;
+    if( route.isRemapped )
+    {
+        entry->irMask = Can::Frame::IR_RTR_MASK;
+        entry->irValue = toIr(route.id, route.isExtended);
+    }
+    entry->dataMask = route.dataMask;
+    entry->dataValue = route.dataValue;
+}
+
+void CanRouter::apply(Entry const& entry, Can::Frame const& frame)
+{
+    Can::Frame copy;
+    copy.ir = (frame.ir & entry.irMask) | entry.irValue;
+    copy.dtr = frame.dtr & Can::Frame::DTR_DLC_MASK;
+    copy.data.v64[0] = (frame.data.v64[0] & entry.dataMask) | entry.dataValue;
+    // The route may be changed by a task, so it is read once
+    Can* const can( entry.can );
+    Target* const target( entry.target );
+    bool_t isForwarded( false );
+    if( can != NULLPTR )
+    {
+        isForwarded = can->forward(copy);
+    }
+    else if( target != NULLPTR )
+    {
+        isForwarded = target->forward(copy);
+    }
+    else
+    {
+        isForwarded = false;
+    }
+    if( isForwarded )
+    {
+        forwarded_++;
+    }
+    else
+    {
+        dropped_++;
+    }
+}
+
+uint32_t CanRouter::toIr(uint32_t id, bool_t isExtended)
+{
+    uint32_t ir( (id & 0x7FF) << Can::Frame::IR_STID_POS );
+    if( isExtended )
+    {
+        ir = ( (id & 0x1FFFFFFF) << Can::Frame::IR_EXID_POS ) | Can::Frame::IR_IDE_MASK;
+    }
+    return ir;
+}
+
+uint32_t CanRouter::hash(uint32_t key)
+{
+    return ( (key >> Can::Frame::IR_STID_POS) ^ (key >> Can::Frame::IR_EXID_POS) ) & (NUMBER_OF_BUCKETS - 1);
+}
+
+} // namespace drv
+} // namespace eoos
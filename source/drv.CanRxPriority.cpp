@@ -0,0 +1,190 @@
+/**
+ * @file      drv.CanRxPriority.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanRxPriority.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+CanRxPriority::CanRxPriority(Can& can, Config const& config)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , can_( can )
+    , index_( config.index )
+    , filters_( 0 )
+    , critical_( can, Can::RXFIFO_0, config.critical.handler )
+    , bulk_( can, Can::RXFIFO_1, config.bulk.handler ) {
+    bool_t const isConstructed( construct(config) );
+    setConstructed( isConstructed );
+}
+
+CanRxPriority::~CanRxPriority()
+{
+}
+
+bool_t CanRxPriority::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+uint32_t CanRxPriority::getNumberOfFilters() const
+{
+    return filters_;
+}
+
+bool_t CanRxPriority::construct(Config const& config)
+{
+    bool_t res( false );
+    do
+    {
+        if( !isConstructed() )
+        {
+            break;
+        }
+        if( !can_.isConstructed() )
+        {
+            break;
+        }
+        if( !critical_.isConstructed() || !bulk_.isConstructed() )
+        {
+            break;
+        }
+        if( !setReceiveFilters(config.critical, Can::RxFilter::FIFO_0) )
+        {
+            break;
+        }
+        if( !setReceiveFilters(config.bulk, Can::RxFilter::FIFO_1) )
+        {
+            break;
+        }
+        if( !critical_.execute(config.critical.priority) )
+        {
+            break;
+        }
+        if( !bulk_.execute(config.bulk.priority) )
+        {
+            break;
+        }
+        res = true;
+    } while(false);
+    return res;
+}
+
+bool_t CanRxPriority::setReceiveFilters(Class const& cls, Can::RxFilter::Fifo fifo)
+{
+    bool_t res( true );
+    int32_t perFilter( NUMBER_OF_STANDARD_IDS_IN_FILTER );
+    if( cls.isExtended )
+    {
+        perFilter = NUMBER_OF_EXTENDED_IDS_IN_FILTER;
+    }
+    for(int32_t i(0); i<cls.number; i += perFilter)
+    {
+        if( index_ + filters_ >= Can::RxFilter::NUMBER_OF_FILTER_GROUPS )
+        {
+            res = false;
+            break;
+        }
+        Can::RxFilter filter;
+        filter.fifo = fifo;
+        filter.index = index_ + filters_;
+        filter.mode = Can::RxFilter::MODE_IDLIST;
+        // The last identifier fills the rest of the list
+        for(int32_t j(0); j<perFilter; j++)
+        {
+            int32_t k( i + j );
+            if( k >= cls.number )
+            {
+                k = cls.number - 1;
+            }
+            uint32_t const id( cls.ids[k] );
+            if( cls.isExtended )
+            {
+                filter.filters.group32.idList.id[j].value = ( (id & 0x1FFFFFFF) << Can::Frame::IR_EXID_POS ) | Can::Frame::IR_IDE_MASK;
+            }
+            else
+            {
+                filter.filters.group16.idList.id[j].value = static_cast<uint16_t>( (id & 0x7FF) << FILTER16_STID_POS );
+            }
+        }
+        filter.scale = Can::RxFilter::SCALE_16BIT;
+        if( cls.isExtended )
+        {
+            filter.scale = Can::RxFilter::SCALE_32BIT;
+        }
+        if( !can_.setReceiveFilter(filter) )
+        {
+            res = false;
+            break;
+        }
+        filters_++;
+    }
+    return res;
+}
+
+CanRxPriority::Consumer::Consumer(Can& can, Can::RxFifo fifo, Can::Handler* handler)
+    : lib::NonCopyable<lib::NoAllocator>()
+    , api::Task()
+    , can_( can )
+    , fifo_( fifo )
+    , handler_( handler )
+    , isStopped_( false )
+    , isStarted_( false )
+    , thread_( *this ) {
+    bool_t const isConstructed( thread_.isConstructed() );
+    setConstructed( isConstructed );
+}
+
+CanRxPriority::Consumer::~Consumer()
+{
+    if( isStarted_ )
+    {
+        isStopped_ = true;
+        // Wake up the thread waiting for a frame without passing a frame through the driver
+        static_cast<void>( can_.cancel(fifo_) );
+        static_cast<void>( thread_.join() );
+    }
+}
+
+bool_t CanRxPriority::Consumer::isConstructed() const
+{
+    return Parent::isConstructed();
+}
+
+void CanRxPriority::Consumer::start()
+{
+    while( !isStopped_ )
+    {
+        Can::Frame frame;
+        if( !can_.receive(&frame, fifo_) )
+        {
+            break;
+        }
+        if( !isStopped_ )
+        {
+            handler_->handle(&frame, 1, fifo_);
+        }
+    }
+}
+
+size_t CanRxPriority::Consumer::getStackSize() const
+{
+    return STACK_SIZE;
+}
+
+bool_t CanRxPriority::Consumer::execute(int32_t priority)
+{
+    bool_t res( true );
+    if( isConstructed() && handler_ != NULLPTR )
+    {
+        res = thread_.setPriority(priority) && thread_.execute();
+        isStarted_ = res;
+    }
+    return res;
+}
+
+} // namespace drv
+} // namespace eoos
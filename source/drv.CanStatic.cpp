@@ -0,0 +1,177 @@
+/**
+ * @file      drv.CanStatic.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ */
+#include "drv.CanStatic.hpp"
+#include "drv.CanResourceTx.hpp"
+#include "drv.CanResourceRx.hpp"
+#include "drv.CanResourceStatus.hpp"
+
+namespace eoos
+{
+namespace drv
+{
+
+template <Can::Number N>
+CanResourceTx* CanStatic<N>::tx_( NULLPTR );
+
+template <Can::Number N>
+CanResourceRx* CanStatic<N>::rx_( NULLPTR );
+
+template <Can::Number N>
+CanResourceStatus* CanStatic<N>::sce_( NULLPTR );
+
+template <Can::Number N>
+bool_t CanStatic<N>::isAttached()
+{
+    return tx_ != NULLPTR;
+}
+
+template <Can::Number N>
+bool_t CanStatic<N>::transmit(Can::Message const& message)
+{
+    bool_t res( false );
+    CanResourceTx* const tx( tx_ );
+    if( tx != NULLPTR )
+    {
+        res = tx->transmit(message);
+    }
+    return res;
+}
+
+template <Can::Number N>
+bool_t CanStatic<N>::transmit(Can::Frame const& frame)
+{
+    bool_t res( false );
+    CanResourceTx* const tx( tx_ );
+    if( tx != NULLPTR )
+    {
+        res = tx->transmit(frame);
+    }
+    return res;
+}
+
+template <Can::Number N>
+bool_t CanStatic<N>::receive(Can::Message* message, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    CanResourceRx* const rx( rx_ );
+    if( rx != NULLPTR )
+    {
+        res = rx->receive(message, fifo);
+    }
+    return res;
+}
+
+template <Can::Number N>
+bool_t CanStatic<N>::receive(Can::Frame* frame, Can::RxFifo fifo)
+{
+    bool_t res( false );
+    CanResourceRx* const rx( rx_ );
+    if( rx != NULLPTR )
+    {
+        res = rx->receive(frame, fifo);
+    }
+    return res;
+}
+
+template <Can::Number N>
+EOOS_DRV_CAN_RAMFUNC void CanStatic<N>::handleTxInterrupt()
+{
+    CanResourceTx* const tx( tx_ );
+    if( tx != NULLPTR )
+    {
+        tx->handleInterrupt();
+    }
+}
+
+template <Can::Number N>
+EOOS_DRV_CAN_RAMFUNC void CanStatic<N>::handleRxInterrupt(Can::RxFifo fifo)
+{
+    CanResourceRx* const rx( rx_ );
+    if( rx != NULLPTR )
+    {
+        rx->handleInterrupt(fifo);
+    }
+}
+
+template <Can::Number N>
+void CanStatic<N>::handleStatusInterrupt()
+{
+    CanResourceStatus* const sce( sce_ );
+    if( sce != NULLPTR )
+    {
+        sce->handleInterrupt();
+    }
+}
+
+template <Can::Number N>
+bool_t CanStatic<N>::attach(CanResourceTx* tx, CanResourceRx* rx, CanResourceStatus* sce)
+{
+    bool_t res( false );
+    // Own the controller by the TX resource at once, so only one of concurrent resources attaches
+    if( tx != NULLPTR && rx != NULLPTR && __sync_bool_compare_and_swap(&tx_, static_cast<CanResourceTx*>(NULLPTR), tx) )
+    {
+        sce_ = sce;
+        rx_ = rx;
+        res = true;
+    }
+    return res;
+}
+
+template <Can::Number N>
+void CanStatic<N>::detach(CanResourceTx* tx)
+{
+    if( tx_ == tx )
+    {
+        tx_ = NULLPTR;
+        rx_ = NULLPTR;
+        sce_ = NULLPTR;
+    }
+}
+
+/**
+ * @brief The static interface for every controller.
+ */
+template class CanStatic<Can::NUMBER_CAN1>;
+template class CanStatic<Can::NUMBER_CAN2>;
+
+} // namespace drv
+} // namespace eoos
+
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_VECTORS == 1
+
+/**
+ * @brief CAN1 TX interrupt vector shared with USB high priority.
+ */
+extern "C" EOOS_DRV_CAN_RAMFUNC void USB_HP_CAN1_TX_IRQHandler()
+{
+    eoos::drv::CanStatic<eoos::drv::Can::NUMBER_CAN1>::handleTxInterrupt();
+}
+
+/**
+ * @brief CAN1 RX FIFO 0 interrupt vector shared with USB low priority.
+ */
+extern "C" EOOS_DRV_CAN_RAMFUNC void USB_LP_CAN1_RX0_IRQHandler()
+{
+    eoos::drv::CanStatic<eoos::drv::Can::NUMBER_CAN1>::handleRxInterrupt(eoos::drv::Can::RXFIFO_0);
+}
+
+/**
+ * @brief CAN1 RX FIFO 1 interrupt vector.
+ */
+extern "C" EOOS_DRV_CAN_RAMFUNC void CAN1_RX1_IRQHandler()
+{
+    eoos::drv::CanStatic<eoos::drv::Can::NUMBER_CAN1>::handleRxInterrupt(eoos::drv::Can::RXFIFO_1);
+}
+
+/**
+ * @brief CAN1 status change error interrupt vector.
+ */
+extern "C" void CAN1_SCE_IRQHandler()
+{
+    eoos::drv::CanStatic<eoos::drv::Can::NUMBER_CAN1>::handleStatusInterrupt();
+}
+
+#endif
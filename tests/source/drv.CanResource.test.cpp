@@ -0,0 +1,918 @@
+/**
+ * @file      drv.CanResource.test.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ *
+ * @brief Unit tests of `drv::CanResource`.
+ */
+#include "drv.CanResource.hpp"
+#include "drv.CanDescriptor.hpp"
+#include "drv.CanStatic.hpp"
+#include "drv.CanRegister.hpp"
+#include "drv.CanRouter.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace eoos
+{
+namespace drv
+{
+namespace
+{
+
+/**
+ * @brief Clock enable mask of CAN2 in RCC_APB1ENR.
+ */
+const uint32_t CAN2_CLOCK( 0x04000000 );
+
+class InterruptController;
+
+/**
+ * @class Interrupt
+ * @brief Host model of a CPU interrupt resource.
+ *
+ * A thread disabling the interrupt holds back its raises till the thread enables it,
+ * and a raise runs the routine in the thread of the hardware model.
+ */
+class Interrupt : public api::CpuInterrupt
+{
+
+public:
+
+    Interrupt(api::Runnable& routine, InterruptController& ic, int32_t source);
+    virtual ~Interrupt();
+    virtual bool_t isConstructed() const { return true; }
+    virtual void enable();
+    virtual bool_t disable();
+    virtual void jump() {}
+
+    /**
+     * @brief Raises the interrupt.
+     */
+    void raise();
+
+    /**
+     * @brief Tests if the calling thread disabled the interrupt.
+     *
+     * @return True if the interrupt is disabled by the thread.
+     */
+    bool_t isDisabled() const;
+
+private:
+
+    api::Runnable& routine_;                  ///< Interrupt routine.
+    InterruptController& ic_;                 ///< Interrupt controller.
+    int32_t source_;                          ///< Interrupt source.
+    std::mutex lock_;                         ///< Lock of disabled interrupt.
+    std::atomic<std::thread::id> owner_;      ///< Thread which disabled the interrupt.
+    std::atomic<bool> isEnabled_;             ///< The interrupt is enabled.
+};
+
+/**
+ * @class InterruptController
+ * @brief Host model of the CPU interrupt controller.
+ */
+class InterruptController : public api::CpuInterruptController
+{
+
+public:
+
+    virtual api::CpuInterrupt* createResource(api::Runnable& routine, int32_t source)
+    {
+        return new Interrupt(routine, *this, source);
+    }
+
+    /**
+     * @brief Raises an interrupt of a source.
+     *
+     * @param source An interrupt source.
+     */
+    void raise(int32_t source)
+    {
+        std::lock_guard<std::mutex> const guard(lock_);
+        std::map<int32_t, Interrupt*>::iterator const it( interrupts_.find(source) );
+        if( it != interrupts_.end() )
+        {
+            it->second->raise();
+        }
+    }
+
+    /**
+     * @brief Tests if the calling thread disabled an interrupt of a source.
+     *
+     * @param source An interrupt source.
+     * @return True if the interrupt is disabled by the thread.
+     */
+    bool_t isDisabled(int32_t source)
+    {
+        std::lock_guard<std::mutex> const guard(lock_);
+        std::map<int32_t, Interrupt*>::iterator const it( interrupts_.find(source) );
+        return ( it != interrupts_.end() ) ? it->second->isDisabled() : false;
+    }
+
+    /**
+     * @brief Registers an interrupt.
+     *
+     * @param source An interrupt source.
+     * @param interrupt An interrupt, or NULLPTR to unregister.
+     */
+    void set(int32_t source, Interrupt* interrupt)
+    {
+        std::lock_guard<std::mutex> const guard(lock_);
+        if( interrupt != NULLPTR )
+        {
+            interrupts_[source] = interrupt;
+        }
+        else
+        {
+            interrupts_.erase(source);
+        }
+    }
+
+private:
+
+    std::mutex lock_;                           ///< Lock of interrupts.
+    std::map<int32_t, Interrupt*> interrupts_;  ///< Interrupts by sources.
+};
+
+Interrupt::Interrupt(api::Runnable& routine, InterruptController& ic, int32_t source)
+    : routine_( routine )
+    , ic_( ic )
+    , source_( source )
+    , lock_()
+    , owner_()
+    , isEnabled_( false )
+{
+    ic_.set(source_, this);
+}
+
+Interrupt::~Interrupt()
+{
+    ic_.set(source_, NULLPTR);
+    if( owner_ == std::this_thread::get_id() )
+    {
+        lock_.unlock();
+    }
+}
+
+void Interrupt::enable()
+{
+    if( owner_ == std::this_thread::get_id() )
+    {
+        owner_ = std::thread::id();
+        lock_.unlock();
+    }
+    isEnabled_ = true;
+}
+
+bool_t Interrupt::disable()
+{
+    if( owner_ != std::this_thread::get_id() )
+    {
+        lock_.lock();
+        owner_ = std::this_thread::get_id();
+    }
+    return isEnabled_;
+}
+
+void Interrupt::raise()
+{
+    std::lock_guard<std::mutex> const guard(lock_);
+    if( isEnabled_ )
+    {
+        routine_.start();
+    }
+}
+
+bool_t Interrupt::isDisabled() const
+{
+    return ( owner_ == std::this_thread::get_id() ) ? true : false;
+}
+
+/**
+ * @class PllController
+ * @brief Host model of the CPU PLL controller of SYSCLK of 72 MHz.
+ */
+class PllController : public api::CpuPllController
+{
+
+public:
+
+    virtual int64_t getCpuClock() { return 72000000; }
+};
+
+/**
+ * @class Processor
+ * @brief Host model of the CPU.
+ */
+class Processor : public api::CpuProcessor
+{
+
+public:
+
+    virtual api::CpuInterruptController& getInterruptController() { return ic_; }
+    virtual api::CpuPllController& getPllController() { return pll_; }
+
+    /**
+     * @brief Raises an interrupt of a source.
+     *
+     * @param source An interrupt source.
+     */
+    void raise(int32_t source) { ic_.raise(source); }
+
+    /**
+     * @brief Tests if the calling thread disabled an interrupt of a source.
+     *
+     * @param source An interrupt source.
+     * @return True if the interrupt is disabled by the thread.
+     */
+    bool_t isDisabled(int32_t source) { return ic_.isDisabled(source); }
+
+private:
+
+    InterruptController ic_; ///< Interrupt controller.
+    PllController pll_;      ///< PLL controller.
+};
+
+/**
+ * @class Supervisor
+ * @brief Host model of the supervisor call.
+ */
+class Supervisor : public api::Supervisor
+{
+
+public:
+
+    virtual api::CpuProcessor& getProcessor() { return cpu_; }
+
+    /**
+     * @brief Raises an interrupt of a source.
+     *
+     * @param source An interrupt source.
+     */
+    void raise(int32_t source) { cpu_.raise(source); }
+
+    /**
+     * @brief Tests if the calling thread disabled an interrupt of a source.
+     *
+     * @param source An interrupt source.
+     * @return True if the interrupt is disabled by the thread.
+     */
+    bool_t isDisabled(int32_t source) { return cpu_.isDisabled(source); }
+
+private:
+
+    Processor cpu_; ///< CPU.
+};
+
+/**
+ * @class Timebase
+ * @brief Host model of a time source which never advances.
+ */
+class Timebase : public CanTimebase
+{
+
+public:
+
+    virtual bool_t isConstructed() const { return true; }
+    virtual uint32_t getTime() { return 0; }
+};
+
+/**
+ * @class Controller
+ * @brief Host model of registers of one controller and its pins.
+ */
+class Controller
+{
+
+public:
+
+    Controller()
+    {
+        std::memset(&can, 0, sizeof(can));
+        std::memset(&rcc, 0, sizeof(rcc));
+        std::memset(&gpio, 0, sizeof(gpio));
+        std::memset(&dbg, 0, sizeof(dbg));
+        std::memset(&reg, 0, sizeof(reg));
+        reg.can[0] = &can;
+        reg.rcc = &rcc;
+        reg.dbg = &dbg;
+        for(int32_t i(0); i<static_cast<int32_t>(sizeof(reg.gpio) / sizeof(reg.gpio[0])); i++)
+        {
+            reg.gpio[i] = &gpio;
+        }
+    }
+
+    cpu::reg::Can  can;  ///< CAN registers.
+    cpu::reg::Rcc  rcc;  ///< RCC registers.
+    cpu::reg::Gpio gpio; ///< GPIO registers.
+    cpu::reg::Dbg  dbg;  ///< Debug registers.
+    cpu::Registers reg;  ///< Register model of the controller.
+};
+
+/**
+ * @class Target
+ * @brief Route target which tests interrupts of a controller are disabled on forwarding.
+ */
+class Target : public CanRouter::Target
+{
+
+public:
+
+    Target(Supervisor& svc, CanDescriptor const& descriptor)
+        : svc_( svc )
+        , descriptor_( descriptor )
+        , forwarded_( 0 )
+        , unmasked_( 0 ) {
+    }
+
+    virtual bool_t forward(Can::Frame const&)
+    {
+        if( !svc_.isDisabled(descriptor_.exceptionTx) || !svc_.isDisabled(descriptor_.exceptionRx0) || !svc_.isDisabled(descriptor_.exceptionRx1) )
+        {
+            unmasked_++;
+        }
+        forwarded_++;
+        return true;
+    }
+
+    Supervisor& svc_;                   ///< Supervisor call.
+    CanDescriptor const& descriptor_;   ///< Descriptor of the controller.
+    int32_t forwarded_;                 ///< Number of frames forwarded.
+    int32_t unmasked_;                  ///< Number of frames forwarded with an interrupt enabled.
+};
+
+/**
+ * @class Hardware
+ * @brief Host model of a controller which loops frames transmitted back to RX FIFO 0.
+ *
+ * The model transmits requests in their chronological order as TXFP is set,
+ * and holds a frame back from RX FIFO 0 while filter bank 0 is not active
+ * or the receiver has a window of frames in flight.
+ */
+class Hardware
+{
+
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param hw A controller.
+     * @param svc A supervisor call.
+     * @param descriptor A descriptor of the controller.
+     * @param consumed A number of frames received by the receiver.
+     * @param window A number of frames in flight to the receiver.
+     */
+    Hardware(Controller& hw, Supervisor& svc, CanDescriptor const& descriptor, std::atomic<int32_t> const& consumed, int32_t window)
+        : hw_( hw )
+        , svc_( svc )
+        , descriptor_( descriptor )
+        , consumed_( consumed )
+        , window_( window )
+        , delivered_( 0 )
+        , transmitted_( 0 )
+        , isStopped_( false )
+        , thread_()
+    {
+        hw_.can.tsr.value = getEmptyMailboxes();
+        thread_ = std::thread(&Hardware::run, this);
+    }
+
+    ~Hardware()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Stops the model.
+     */
+    void stop()
+    {
+        isStopped_ = true;
+        if( thread_.joinable() )
+        {
+            thread_.join();
+        }
+    }
+
+    /**
+     * @brief Returns a number of frames transmitted.
+     *
+     * @return The number of frames.
+     */
+    int32_t getTransmitted() const
+    {
+        return transmitted_;
+    }
+
+private:
+
+    /**
+     * @brief Runs the model.
+     */
+    void run()
+    {
+        while( !isStopped_ )
+        {
+            transmit();
+            receive();
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Transmits the earliest request of mailboxes.
+     */
+    void transmit()
+    {
+        int32_t index( -1 );
+        for(int32_t i(0); i<3; i++)
+        {
+            cpu::reg::Can::Tx volatile& tx( hw_.can.tx[i] );
+            if( (tx.tixr.value & CanRegister::Tixr::Txrq::MASK) == 0 )
+            {
+                continue;
+            }
+            if( index < 0 || static_cast<int32_t>(tx.tdlxr.value - hw_.can.tx[index].tdlxr.value) < 0 )
+            {
+                index = i;
+            }
+        }
+        if( index >= 0 )
+        {
+            cpu::reg::Can::Tx volatile& tx( hw_.can.tx[index] );
+            Can::Frame frame;
+            frame.ir = tx.tixr.value & ~CanRegister::Tixr::Txrq::MASK;
+            frame.dtr = tx.tdtxr.value;
+            frame.data.v32[0] = tx.tdlxr.value;
+            frame.data.v32[1] = tx.tdhxr.value;
+            bus_.push_back(frame);
+            transmitted_++;
+            tx.tixr.value = frame.ir;
+            // The status is set for one mailbox at once, as the routine clears it by writing one
+            uint32_t const status( CanRegisterMask<CanRegister::Tsr::Rqcp, CanRegister::Tsr::Txok>::MASK );
+            hw_.can.tsr.value = getEmptyMailboxes() | ( status << (CanRegister::Tsr::MAILBOX_POS * index) );
+            svc_.raise(descriptor_.exceptionTx);
+            hw_.can.tsr.value = getEmptyMailboxes();
+        }
+    }
+
+    /**
+     * @brief Puts a frame transmitted to RX FIFO 0.
+     */
+    void receive()
+    {
+        cpu::reg::Can::RfXr volatile& rfxr( hw_.can.rfxr[0] );
+        if( CanRegister::Rfxr::Fmp::get(rfxr.value) == 0 && !bus_.empty()
+         && (hw_.can.fmr.value & CanRegister::Fmr::Finit::MASK) == 0 && (hw_.can.fa1r.value & 1) != 0
+         && delivered_ - consumed_ < window_ )
+        {
+            Can::Frame const& frame( bus_.front() );
+            cpu::reg::Can::Rx volatile& rx( hw_.can.rx[0] );
+            rx.rixr.value = frame.ir;
+            rx.rdtxr.value = frame.dtr;
+            rx.rdlxr.value = frame.data.v32[0];
+            rx.rdhxr.value = frame.data.v32[1];
+            bus_.pop_front();
+            delivered_++;
+            rfxr.value = 1;
+        }
+        // The interrupt is raised while a frame is pending
+        if( CanRegister::Rfxr::Fmp::get(rfxr.value) != 0 )
+        {
+            svc_.raise(descriptor_.exceptionRx0);
+        }
+    }
+
+    /**
+     * @brief Returns TME bits of mailboxes without a transmit request.
+     *
+     * @return The bits of CAN_TSR.
+     */
+    uint32_t getEmptyMailboxes() const
+    {
+        uint32_t tme( 0 );
+        for(int32_t i(0); i<3; i++)
+        {
+            if( (hw_.can.tx[i].tixr.value & CanRegister::Tixr::Txrq::MASK) == 0 )
+            {
+                tme |= CanRegister::Tsr::Tme::MASK << i;
+            }
+        }
+        return tme;
+    }
+
+    Controller& hw_;                          ///< Controller.
+    Supervisor& svc_;                         ///< Supervisor call.
+    CanDescriptor const& descriptor_;         ///< Descriptor of the controller.
+    std::atomic<int32_t> const& consumed_;    ///< Number of frames received by the receiver.
+    int32_t window_;                          ///< Number of frames in flight to the receiver.
+    int32_t delivered_;                       ///< Number of frames put to RX FIFO 0.
+    std::atomic<int32_t> transmitted_;        ///< Number of frames transmitted.
+    std::atomic<bool> isStopped_;             ///< The model is stopped.
+    std::deque<Can::Frame> bus_;              ///< Frames transmitted and not received.
+    std::thread thread_;                      ///< Thread of the model.
+};
+
+} // namespace
+
+/**
+ * @class drv_CanResource_test
+ * @test CanResource
+ * @brief Tests CanResource class functionality.
+ */
+class drv_CanResource_test : public ::testing::Test
+{
+
+protected:
+
+    typedef CanResource<lib::NoAllocator> Resource;
+
+    /**
+     * @brief Returns a configuration of an asynchronous initialization.
+     *
+     * @param number A number of the controller.
+     * @return The configuration.
+     */
+    Can::Config getConfig(Can::Number number)
+    {
+        Can::Config config;
+        std::memset(&config, 0, sizeof(config));
+        config.number = number;
+        config.bitRate = Can::BITRATE_500;
+        config.samplePoint = Can::SAMPLEPOINT_CANOPEN;
+        config.timebase = &timebase_;
+        config.isAsync = true;
+        return config;
+    }
+
+    /**
+     * @brief Descriptor of a second controller which the target table does not list.
+     */
+    static CanDescriptor const can2_;
+
+    Supervisor svc_;      ///< Supervisor call.
+    Timebase   timebase_; ///< Time source.
+};
+
+CanDescriptor const drv_CanResource_test::can2_ = {
+    Can::NUMBER_CAN2, // CAN2
+    0,                // Registers of the host model
+    100,              // Transmit interrupt
+    101,              // FIFO 0 interrupt
+    102,              // FIFO 1 interrupt
+    103,              // Status change error interrupt
+    CAN2_CLOCK,       // RCC_APB1ENR.CAN2EN
+    0x00200000,       // DBGMCU_CR.DBG_CAN2_STOP
+    1,                // IO port B
+    0x00000008,       // RCC_APB2ENR.IOPBEN
+    12,               // CAN2_RX port PB12
+    13                // CAN2_TX port PB13
+};
+
+/**
+ * @relates drv_CanResource_test
+ * @brief Tests a resource is built from a descriptor of a second controller.
+ *
+ * @b Arrange:
+ *      Take a host model descriptor of CAN2.
+ *
+ * @b Act:
+ *      Construct a resource from the descriptor and destroy it.
+ *
+ * @b Assert:
+ *      Test the resource owns CAN2 only, enables its clock, and releases both on destruction.
+ */
+TEST_F(drv_CanResource_test, Constructor_secondDescriptor)
+{
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    {
+        Resource resource(data, can2_, getConfig(Can::NUMBER_CAN2));
+        EXPECT_TRUE(resource.isConstructed()) << "Fatal: Resource of CAN2 is not constructed";
+        EXPECT_TRUE(CanStatic<Can::NUMBER_CAN2>::isAttached()) << "Fatal: Resource does not own CAN2";
+        EXPECT_FALSE(CanStatic<Can::NUMBER_CAN1>::isAttached()) << "Fatal: Resource of CAN2 owns CAN1";
+        EXPECT_EQ(CAN2_CLOCK, hw.rcc.apb1enr.value & CAN2_CLOCK) << "Fatal: Clock of CAN2 is not enabled";
+    }
+    EXPECT_FALSE(CanStatic<Can::NUMBER_CAN2>::isAttached()) << "Fatal: Resource destroyed still owns CAN2";
+    EXPECT_EQ(0u, hw.rcc.apb1enr.value & CAN2_CLOCK) << "Fatal: Clock of CAN2 is not disabled";
+}
+
+/**
+ * @relates drv_CanResource_test
+ * @brief Tests a second resource of an owned controller does not touch the controller.
+ *
+ * @b Arrange:
+ *      Construct a resource of CAN2.
+ *
+ * @b Act:
+ *      Construct and destroy one more resource of CAN2.
+ *
+ * @b Assert:
+ *      Test the second resource is not constructed, and the first one keeps the controller.
+ */
+TEST_F(drv_CanResource_test, Constructor_ownedController)
+{
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    Resource owner(data, can2_, getConfig(Can::NUMBER_CAN2));
+    ASSERT_TRUE(owner.isConstructed()) << "Fatal: Resource of CAN2 is not constructed";
+    hw.can.ier.value = 0x0000FFFF;
+    {
+        Resource other(data, can2_, getConfig(Can::NUMBER_CAN2));
+        EXPECT_FALSE(other.isConstructed()) << "Fatal: Two resources own CAN2";
+    }
+    EXPECT_TRUE(CanStatic<Can::NUMBER_CAN2>::isAttached()) << "Fatal: Resource lost CAN2";
+    EXPECT_EQ(0x0000FFFFu, hw.can.ier.value) << "Fatal: Interrupts of the owner are disabled";
+    EXPECT_EQ(CAN2_CLOCK, hw.rcc.apb1enr.value & CAN2_CLOCK) << "Fatal: Clock of the owner is disabled";
+}
+
+/**
+ * @relates drv_CanResource_test
+ * @brief Tests a descriptor of other controller is rejected.
+ *
+ * @b Arrange:
+ *      Take a descriptor of CAN2.
+ *
+ * @b Act:
+ *      Construct a resource configured for CAN1 from the descriptor.
+ *
+ * @b Assert:
+ *      Test the resource is not constructed, and no controller is owned.
+ */
+TEST_F(drv_CanResource_test, Constructor_wrongNumber)
+{
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    {
+        Resource resource(data, can2_, getConfig(Can::NUMBER_CAN1));
+        EXPECT_FALSE(resource.isConstructed()) << "Fatal: Resource of wrong number is constructed";
+    }
+    EXPECT_FALSE(CanStatic<Can::NUMBER_CAN1>::isAttached()) << "Fatal: CAN1 is owned";
+    EXPECT_FALSE(CanStatic<Can::NUMBER_CAN2>::isAttached()) << "Fatal: CAN2 is owned";
+}
+
+/**
+ * @relates drv_CanResource_test
+ * @brief Tests a message is injected with the interrupts of the controller disabled.
+ *
+ * @b Arrange:
+ *      Initialize a resource of CAN2 with a router, which forwards frames to a target testing the interrupts.
+ *
+ * @b Act:
+ *      Inject messages to RX FIFO 0 till it is full.
+ *
+ * @b Assert:
+ *      Test the target gets messages with the TX and RX interrupts disabled, which are enabled after,
+ *      and a message not queued is not injected.
+ */
+TEST_F(drv_CanResource_test, Inject_masksInterrupts)
+{
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    Resource resource(data, can2_, getConfig(Can::NUMBER_CAN2));
+    ASSERT_TRUE(resource.isConstructed()) << "Fatal: Resource of CAN2 is not constructed";
+    Target target(svc_, can2_);
+    CanRouter router;
+    CanRouter::Route route;
+    std::memset(&route, 0, sizeof(route));
+    route.target = &target;
+    ASSERT_TRUE(router.setRoute(0x123, false, route)) << "Fatal: Route is not set";
+    ASSERT_TRUE(resource.setRouter(&router)) << "Fatal: Router is not set";
+    Can::Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.id.stid = 0x123;
+    message.dlc = 8;
+    int32_t injected( 0 );
+    while( resource.inject(message, Can::RXFIFO_0) )
+    {
+        injected++;
+        ASSERT_GT(100, injected) << "Fatal: Message is injected to full FIFO";
+    }
+    EXPECT_EQ(3, injected) << "Fatal: Messages are not injected till SW FIFO is full";
+    EXPECT_EQ(injected, target.forwarded_) << "Fatal: Messages are not routed";
+    EXPECT_EQ(0, target.unmasked_) << "Fatal: Messages are injected with an interrupt enabled";
+    EXPECT_FALSE(svc_.isDisabled(can2_.exceptionTx)) << "Fatal: TX interrupt is left disabled";
+    EXPECT_FALSE(svc_.isDisabled(can2_.exceptionRx0)) << "Fatal: FIFO 0 interrupt is left disabled";
+    EXPECT_FALSE(svc_.isDisabled(can2_.exceptionRx1)) << "Fatal: FIFO 1 interrupt is left disabled";
+}
+
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES == 1
+/**
+ * @relates drv_CanResource_test
+ * @brief Tests a message dropped by a consumer lane is not injected.
+ *
+ * @b Arrange:
+ *      Construct a resource of CAN2 with one consumer lane of RX FIFO 0.
+ *
+ * @b Act:
+ *      Inject messages to RX FIFO 0 till an injection fails.
+ *
+ * @b Assert:
+ *      Test the injection fails as the lane drops a message.
+ */
+TEST_F(drv_CanResource_test, Inject_laneDrop)
+{
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    Resource resource(data, can2_, getConfig(Can::NUMBER_CAN2));
+    ASSERT_TRUE(resource.isConstructed()) << "Fatal: Resource of CAN2 is not constructed";
+    ASSERT_TRUE(resource.setConsumers(Can::RXFIFO_0, 1)) << "Fatal: Consumers are not set";
+    Can::Message message;
+    std::memset(&message, 0, sizeof(message));
+    int32_t injected( 0 );
+    while( resource.inject(message, Can::RXFIFO_0) )
+    {
+        injected++;
+        ASSERT_GT(100, injected) << "Fatal: Message is injected to full lane";
+    }
+    EXPECT_LT(0, injected) << "Fatal: Messages are not injected to the lane";
+    EXPECT_EQ(1, resource.getLaneDropCounter(Can::RXFIFO_0)) << "Fatal: Message is not dropped by the lane";
+}
+#endif // EOOS_GLOBAL_DRV_CAN_ENABLE_RXLANES
+
+#if EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE == 1
+/**
+ * @relates drv_CanResource_test
+ * @brief Tests an asynchronous transmission is rejected in the sleep mode.
+ *
+ * @b Arrange:
+ *      Initialize a resource of CAN2, which controller acknowledges the sleep mode.
+ *
+ * @b Act:
+ *      Submit an asynchronous transmission in the sleep mode and out of it.
+ *
+ * @b Assert:
+ *      Test the request is rejected without a wake-up in the sleep mode, and is submitted out of it.
+ */
+TEST_F(drv_CanResource_test, TransmitAsync_sleep)
+{
+    /**
+     * @class Completion
+     * @brief Completion which counts requests completed.
+     */
+    class Completion : public Can::Completion
+    {
+
+    public:
+
+        Completion() : completed_( 0 ) {}
+        virtual void complete(Can::Request*) { completed_++; }
+        int32_t completed_; ///< Number of requests completed.
+    };
+
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    Resource resource(data, can2_, getConfig(Can::NUMBER_CAN2));
+    ASSERT_TRUE(resource.isConstructed()) << "Fatal: Resource of CAN2 is not constructed";
+    hw.can.msr.value = 1;
+    static_cast<void>( resource.isReady() );
+    hw.can.msr.value = 0;
+    ASSERT_TRUE(resource.isReady()) << "Fatal: Resource is not initialized";
+    hw.can.tsr.value = CanRegister::Tsr::Tme::MASK;
+    Completion completion;
+    Can::Request request;
+    std::memset(&request, 0, sizeof(request));
+    request.completion = &completion;
+    ASSERT_TRUE(resource.sleep()) << "Fatal: Sleep mode is not requested";
+    hw.can.msr.value = 2;
+    EXPECT_FALSE(resource.transmitAsync(&request)) << "Fatal: Request is submitted in the sleep mode";
+    EXPECT_EQ(1u, hw.can.mcr.bit.sleep) << "Fatal: Controller is woken up by a submission";
+    EXPECT_EQ(0u, hw.can.tx[0].tixr.value & CanRegister::Tixr::Txrq::MASK) << "Fatal: Request is loaded in the sleep mode";
+    ASSERT_TRUE(resource.wakeUp()) << "Fatal: Controller is not woken up";
+    hw.can.msr.value = 0;
+    EXPECT_TRUE(resource.transmitAsync(&request)) << "Fatal: Request is not submitted";
+    EXPECT_NE(0u, hw.can.tx[0].tixr.value & CanRegister::Tixr::Txrq::MASK) << "Fatal: Request is not loaded";
+}
+#endif // EOOS_GLOBAL_DRV_CAN_ENABLE_TXQUEUE
+
+/**
+ * @relates drv_CanResource_test
+ * @brief Stress test of transmission, reception and filter updates executed concurrently.
+ *
+ * @b Arrange:
+ *      Initialize a resource of CAN2 on a host model which loops frames back to RX FIFO 0.
+ *
+ * @b Act:
+ *      Forward frames, receive them, and update filters by three threads at once.
+ *
+ * @b Assert:
+ *      Test every frame is transmitted and received once in order without a torn word,
+ *      and each filter update succeeds and leaves the filters active.
+ */
+TEST_F(drv_CanResource_test, Stress_transmitReceiveFilter)
+{
+    const int32_t NUMBER_OF_FRAMES( 5000 );
+    Controller hw;
+    Resource::Data data(hw.reg, svc_);
+    Can::Config config( getConfig(Can::NUMBER_CAN2) );
+    // The host runs the RX interrupt in parallel with consumers, which the overwrite of the last frame does not allow
+    config.reg.mcr.rflm = 1;
+    Resource resource(data, can2_, config);
+    ASSERT_TRUE(resource.isConstructed()) << "Fatal: Resource of CAN2 is not constructed";
+    hw.can.msr.value = 1;
+    static_cast<void>( resource.isReady() );
+    hw.can.msr.value = 0;
+    ASSERT_TRUE(resource.isReady()) << "Fatal: Resource is not initialized";
+
+    Can::RxFilter filter;
+    std::memset(&filter, 0, sizeof(filter));
+    filter.fifo = Can::RxFilter::FIFO_0;
+    filter.index = 0;
+    filter.mode = Can::RxFilter::MODE_IDMASK;
+    filter.scale = Can::RxFilter::SCALE_32BIT;
+    ASSERT_TRUE(resource.setReceiveFilter(filter)) << "Fatal: Filter is not set";
+
+    std::atomic<int32_t> consumed( 0 );
+    std::atomic<bool> isTransmitted( false );
+    std::atomic<bool> isCancelled( false );
+    std::atomic<int32_t> tornFrames( 0 );
+    std::atomic<int32_t> disorderedFrames( 0 );
+    std::atomic<int32_t> failedFilters( 0 );
+    Hardware model(hw, svc_, can2_, consumed, 2);
+
+    std::thread transmitter([&]()
+    {
+        for(int32_t i(0); i<NUMBER_OF_FRAMES; i++)
+        {
+            Can::Frame frame;
+            frame.ir = static_cast<uint32_t>(i & 0x7FF) << Can::Frame::IR_STID_POS;
+            frame.dtr = 8;
+            frame.data.v32[0] = static_cast<uint32_t>(i);
+            frame.data.v32[1] = ~static_cast<uint32_t>(i);
+            while( !resource.forward(frame) )
+            {
+                std::this_thread::yield();
+            }
+        }
+        isTransmitted = true;
+    });
+    std::thread receiver([&]()
+    {
+        while( consumed < NUMBER_OF_FRAMES && !isCancelled )
+        {
+            Can::Frame frame;
+            if( !resource.receive(&frame, Can::RXFIFO_0) )
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t const i( frame.data.v32[0] );
+            if( frame.data.v32[1] != ~i || (frame.ir >> Can::Frame::IR_STID_POS) != (i & 0x7FF) )
+            {
+                tornFrames++;
+            }
+            if( i != static_cast<uint32_t>(consumed) )
+            {
+                disorderedFrames++;
+            }
+            consumed++;
+        }
+    });
+    std::thread updater([&]()
+    {
+        uint32_t index( 1 );
+        while( !isTransmitted )
+        {
+            Can::RxFilter other( filter );
+            other.fifo = Can::RxFilter::FIFO_1;
+            other.index = index;
+            other.mode = Can::RxFilter::MODE_IDLIST;
+            other.filters.group32.idList.id[0].bit.stid = index;
+            if( !resource.setReceiveFilter(filter) || !resource.setReceiveFilter(other) )
+            {
+                failedFilters++;
+            }
+            index = ( index < Can::RxFilter::NUMBER_OF_FILTER_GROUPS - 1 ) ? index + 1 : 1;
+        }
+    });
+
+    transmitter.join();
+    updater.join();
+    for(int32_t i(0); i<10000 && consumed < NUMBER_OF_FRAMES; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Release the receiver if it waits for a frame lost
+    isCancelled = true;
+    static_cast<void>( resource.cancel(Can::RXFIFO_0) );
+    receiver.join();
+    model.stop();
+
+    EXPECT_EQ(NUMBER_OF_FRAMES, model.getTransmitted()) << "Fatal: Frames are not transmitted once";
+    EXPECT_EQ(NUMBER_OF_FRAMES, consumed.load()) << "Fatal: Frames are not received";
+    EXPECT_EQ(0, tornFrames.load()) << "Fatal: Frames are torn";
+    EXPECT_EQ(0, disorderedFrames.load()) << "Fatal: Frames are disordered";
+    EXPECT_EQ(0, failedFilters.load()) << "Fatal: Filters are not updated";
+    EXPECT_EQ(0u, hw.can.fmr.value & CanRegister::Fmr::Finit::MASK) << "Fatal: Filters are left in initialization mode";
+    EXPECT_NE(0u, hw.can.fa1r.value & 1) << "Fatal: Filter of FIFO 0 is left inactive";
+}
+
+} // namespace drv
+} // namespace eoos
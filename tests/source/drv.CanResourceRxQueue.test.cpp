@@ -0,0 +1,206 @@
+/**
+ * @file      drv.CanResourceRxQueue.test.cpp
+ * @author    Sergey Baigudin, sergey@baigudin.software
+ * @copyright 2024, Sergey Baigudin, Baigudin Software
+ *
+ * @brief Unit tests of `drv::CanResourceRxQueue`.
+ */
+#include "drv.CanResourceRxQueue.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace eoos
+{
+namespace drv
+{
+
+/**
+ * @class drv_CanResourceRxQueue_test
+ * @test CanResourceRxQueue
+ * @brief Tests CanResourceRxQueue class functionality.
+ */
+class drv_CanResourceRxQueue_test : public ::testing::Test
+{
+
+protected:
+
+    typedef CanResourceRxQueue<3> Queue;
+
+    /**
+     * @brief Returns a frame of a number.
+     *
+     * @param number A number of the frame.
+     * @return The frame.
+     */
+    static Can::Frame getFrame(uint32_t number)
+    {
+        Can::Frame frame;
+        frame.ir = (number & 0x7FF) << Can::Frame::IR_STID_POS;
+        frame.dtr = 8;
+        frame.data.v32[0] = number;
+        frame.data.v32[1] = ~number;
+        return frame;
+    }
+};
+
+/**
+ * @relates drv_CanResourceRxQueue_test
+ * @brief Tests a queue length which is not a power of two.
+ *
+ * @b Arrange:
+ *      Construct a queue of three frames.
+ *
+ * @b Act:
+ *      Put and get frames through many laps of positions.
+ *
+ * @b Assert:
+ *      Test the queue keeps three frames, and gives them in order.
+ */
+TEST_F(drv_CanResourceRxQueue_test, PutGet_laps)
+{
+    Queue queue(true);
+    ASSERT_TRUE(queue.isConstructed()) << "Fatal: Queue is not constructed";
+    uint32_t put( 0 );
+    uint32_t got( 0 );
+    for(int32_t i(0); i<1000; i++)
+    {
+        while( queue.put(getFrame(put)) == Queue::RESULT_ADDED )
+        {
+            put++;
+        }
+        ASSERT_TRUE(queue.isFull()) << "Fatal: Queue is not full";
+        ASSERT_EQ(3u, put - got) << "Fatal: Queue does not keep three frames";
+        Can::Frame frame;
+        int32_t const number( i % 3 + 1 );
+        for(int32_t j(0); j<number; j++)
+        {
+            ASSERT_TRUE(queue.get(&frame)) << "Fatal: Frame is not got";
+            ASSERT_EQ(got, frame.data.v32[0]) << "Fatal: Frame is disordered";
+            got++;
+        }
+    }
+    Can::Frame frame;
+    while( queue.get(&frame) )
+    {
+        got++;
+    }
+    EXPECT_EQ(put, got) << "Fatal: Frames are lost";
+    EXPECT_TRUE(queue.isEmpty()) << "Fatal: Queue is not empty";
+}
+
+/**
+ * @relates drv_CanResourceRxQueue_test
+ * @brief Tests a full queue overwrites its last frame if it is not locked.
+ *
+ * @b Arrange:
+ *      Fill a locked queue and an unlocked queue.
+ *
+ * @b Act:
+ *      Put one more frame to the queues.
+ *
+ * @b Assert:
+ *      Test the locked queue rejects the frame, and the unlocked queue puts it in place of the last one.
+ */
+TEST_F(drv_CanResourceRxQueue_test, Put_full)
+{
+    Queue locked(true);
+    Queue unlocked(false);
+    for(uint32_t i(0); i<3; i++)
+    {
+        ASSERT_EQ(Queue::RESULT_ADDED, locked.put(getFrame(i))) << "Fatal: Frame is not added";
+        ASSERT_EQ(Queue::RESULT_ADDED, unlocked.put(getFrame(i))) << "Fatal: Frame is not added";
+    }
+    EXPECT_EQ(Queue::RESULT_REJECTED, locked.put(getFrame(3))) << "Fatal: Locked queue does not reject a frame";
+    EXPECT_EQ(Queue::RESULT_OVERWRITTEN, unlocked.put(getFrame(3))) << "Fatal: Unlocked queue does not overwrite a frame";
+    uint32_t const expected[3] = { 0, 1, 3 };
+    for(int32_t i(0); i<3; i++)
+    {
+        Can::Frame frame;
+        ASSERT_TRUE(unlocked.get(&frame)) << "Fatal: Frame is not got";
+        EXPECT_EQ(expected[i], frame.data.v32[0]) << "Fatal: Frame is wrong";
+    }
+}
+
+/**
+ * @relates drv_CanResourceRxQueue_test
+ * @brief Stress test of one producer and consumers executed concurrently.
+ *
+ * @b Arrange:
+ *      Construct a locked queue, as the overwrite of the last frame expects no consumer executed while the producer is.
+ *
+ * @b Act:
+ *      Put frames by one thread and get them by three threads at once.
+ *
+ * @b Assert:
+ *      Test every frame is got once without a torn word, and each consumer gets frames in order.
+ */
+TEST_F(drv_CanResourceRxQueue_test, Stress_consumers)
+{
+    const int32_t NUMBER_OF_FRAMES( 100000 );
+    const int32_t NUMBER_OF_CONSUMERS( 3 );
+    Queue queue(true);
+    std::vector< std::atomic<int32_t> > got(NUMBER_OF_FRAMES);
+    std::atomic<int32_t> consumed( 0 );
+    std::atomic<int32_t> tornFrames( 0 );
+    std::atomic<int32_t> disorderedFrames( 0 );
+    std::vector<std::thread> consumers;
+    for(int32_t i(0); i<NUMBER_OF_CONSUMERS; i++)
+    {
+        consumers.push_back( std::thread([&]()
+        {
+            int64_t last( -1 );
+            while( consumed < NUMBER_OF_FRAMES )
+            {
+                Can::Frame frame;
+                if( !queue.get(&frame) )
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint32_t const number( frame.data.v32[0] );
+                if( frame.data.v32[1] != ~number || number >= static_cast<uint32_t>(NUMBER_OF_FRAMES) )
+                {
+                    tornFrames++;
+                }
+                else
+                {
+                    got[number]++;
+                }
+                if( static_cast<int64_t>(number) <= last )
+                {
+                    disorderedFrames++;
+                }
+                last = number;
+                consumed++;
+            }
+        }) );
+    }
+    for(int32_t i(0); i<NUMBER_OF_FRAMES; i++)
+    {
+        while( queue.put(getFrame(static_cast<uint32_t>(i))) != Queue::RESULT_ADDED )
+        {
+            std::this_thread::yield();
+        }
+    }
+    for(int32_t i(0); i<NUMBER_OF_CONSUMERS; i++)
+    {
+        consumers[i].join();
+    }
+    int32_t lostFrames( 0 );
+    for(int32_t i(0); i<NUMBER_OF_FRAMES; i++)
+    {
+        if( got[i] != 1 )
+        {
+            lostFrames++;
+        }
+    }
+    EXPECT_EQ(0, tornFrames.load()) << "Fatal: Frames are torn";
+    EXPECT_EQ(0, disorderedFrames.load()) << "Fatal: Frames are disordered";
+    EXPECT_EQ(0, lostFrames) << "Fatal: Frames are lost or got twice";
+    EXPECT_TRUE(queue.isEmpty()) << "Fatal: Queue is not empty";
+}
+
+} // namespace drv
+} // namespace eoos